@@ -0,0 +1,122 @@
+// 对比 nlohmann::json DOM 与 JsonWriter 生成 /players 和玩家详情响应体的耗时
+// 构建: xmake f --bench=y && xmake build serverinfo-rest-bench && xmake run serverinfo-rest-bench
+
+#include "mod/JsonWriter.h"
+#include "mod/PlayerCache.h"
+#include "mod/PlayerJson.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+std::vector<std::shared_ptr<const CachedPlayerInfo>> makePlayers(size_t count) {
+    std::vector<std::shared_ptr<const CachedPlayerInfo>> players;
+    players.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto player = std::make_shared<CachedPlayerInfo>();
+        player->name = "Player_" + std::to_string(i);
+        player->xuid = std::to_string(2535400000000000ull + i * 7919);
+        player->uuid = "5c3e2a4b-1f0d-4e8a-9b7c-" + std::to_string(100000000000ull + i);
+        player->ipAndPort = "192.168.1." + std::to_string(i % 250) + ":19132";
+        player->locale = "zh_CN";
+        player->isOperator = i % 10 == 0;
+        player->posX = 100.5f + static_cast<float>(i);
+        player->posY = 64.0f;
+        player->posZ = -200.3f - static_cast<float>(i);
+        players.push_back(std::move(player));
+    }
+    return players;
+}
+
+// 与改动前 buildResponseBody 中的写法相同
+std::string playersWithDom(const std::vector<std::shared_ptr<const CachedPlayerInfo>>& players) {
+    nlohmann::json json;
+    json["players"] = nlohmann::json::array();
+    for (const auto& player : players) {
+        nlohmann::json playerJson;
+        playerJson["name"] = player->name;
+        playerJson["xuid"] = player->xuid;
+        playerJson["uuid"] = player->uuid;
+        json["players"].push_back(playerJson);
+    }
+    json["count"] = players.size();
+    return json.dump();
+}
+
+std::string playersWithWriter(const std::vector<std::shared_ptr<const CachedPlayerInfo>>& players) {
+    using SnapshotPlayer = std::shared_ptr<const CachedPlayerInfo>;
+    PlayerListEnvelope<SnapshotPlayer> envelope{players, players.size()};
+    return toJson<PlayerListJson<SnapshotPlayer>>(envelope, 64 + players.size() * 128);
+}
+
+std::string detailWithDom(const CachedPlayerInfo& player) {
+    nlohmann::json json;
+    json["name"] = player.name;
+    json["xuid"] = player.xuid;
+    json["uuid"] = player.uuid;
+    json["ipAndPort"] = player.ipAndPort;
+    json["locale"] = player.locale;
+    json["isOperator"] = player.isOperator;
+    json["position"]["x"] = player.posX;
+    json["position"]["y"] = player.posY;
+    json["position"]["z"] = player.posZ;
+    return json.dump();
+}
+
+std::string detailWithWriter(const CachedPlayerInfo& player) {
+    std::string body;
+    body.reserve(384);
+    JsonWriter json(body);
+    json.beginObject();
+    PlayerDetailJson::writeFields(json, player);
+    json.key("position").beginObject();
+    json.field("x", player.posX).field("y", player.posY).field("z", player.posZ);
+    json.endObject().endObject();
+    return body;
+}
+
+// 返回每次调用的平均纳秒数
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        sink += fn().size();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::puts("");
+    return elapsed / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-10s %8s %14s %14s %8s\n", "body", "players", "dom (us)", "writer (us)", "speedup");
+    for (size_t count : {10, 100, 1000}) {
+        auto players = makePlayers(count);
+        // 两种写法的结果必须是等价的 JSON
+        if (nlohmann::json::parse(playersWithDom(players)) != nlohmann::json::parse(playersWithWriter(players))) {
+            std::printf("output mismatch at %zu players\n", count);
+            return 1;
+        }
+        size_t iterations = 200000 / count;
+        double dom = measure(iterations, [&] { return playersWithDom(players); });
+        double writer = measure(iterations, [&] { return playersWithWriter(players); });
+        std::printf("%-10s %8zu %14.2f %14.2f %7.1fx\n", "/players", count, dom / 1000, writer / 1000, dom / writer);
+    }
+
+    auto players = makePlayers(1);
+    const auto& player = *players.front();
+    double dom = measure(200000, [&] { return detailWithDom(player); });
+    double writer = measure(200000, [&] { return detailWithWriter(player); });
+    std::printf("%-10s %8d %14.2f %14.2f %7.1fx\n", "/player", 1, dom / 1000, writer / 1000, dom / writer);
+    return 0;
+}
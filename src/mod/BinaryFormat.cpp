@@ -0,0 +1,526 @@
+#include "mod/BinaryFormat.h"
+#include "mod/Compression.h"
+#include "mod/HttpParser.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <vector>
+
+namespace serverinfo_rest {
+
+namespace {
+
+// ==================== JSON 记号 ====================
+
+// 第一遍扫描得到的记号，容器记号记录元素个数 (MessagePack 的数组和映射头需要事先知道长度)
+struct JsonToken {
+    enum class Kind : uint8_t { Null, False, True, Number, String, Array, Object };
+
+    Kind kind = Kind::Null;
+    bool escaped = false; // 字符串中含有转义序列
+    uint32_t count = 0;   // 数组元素个数或对象键值对个数
+    std::string_view text; // 数字的原文或字符串引号内的原文
+};
+
+// 嵌套层数上限，防止异常输入耗尽栈空间
+constexpr int kMaxDepth = 64;
+
+class JsonTokenizer {
+public:
+    JsonTokenizer(std::string_view text, std::vector<JsonToken>& tokens) : mText(text), mTokens(tokens) {}
+
+    bool run() {
+        if (!parseValue(0)) return false;
+        skipSpace();
+        return mPos == mText.size();
+    }
+
+private:
+    void skipSpace() {
+        while (mPos < mText.size() &&
+               (mText[mPos] == ' ' || mText[mPos] == '\t' || mText[mPos] == '\n' || mText[mPos] == '\r')) {
+            ++mPos;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (mPos < mText.size() && mText[mPos] == c) {
+            ++mPos;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(std::string_view word, JsonToken::Kind kind) {
+        if (mText.substr(mPos, word.size()) != word) return false;
+        mPos += word.size();
+        mTokens.push_back({kind, false, 0, {}});
+        return true;
+    }
+
+    bool parseString() {
+        size_t start = ++mPos;
+        bool escaped = false;
+        while (mPos < mText.size()) {
+            char c = mText[mPos];
+            if (c == '"') {
+                mTokens.push_back({JsonToken::Kind::String, escaped, 0, mText.substr(start, mPos - start)});
+                ++mPos;
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c == '\\') {
+                escaped = true;
+                ++mPos;
+            }
+            ++mPos;
+        }
+        return false;
+    }
+
+    bool parseNumber() {
+        size_t start = mPos;
+        while (mPos < mText.size()) {
+            char c = mText[mPos];
+            if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+                ++mPos;
+            } else {
+                break;
+            }
+        }
+        if (mPos == start) return false;
+        mTokens.push_back({JsonToken::Kind::Number, false, 0, mText.substr(start, mPos - start)});
+        return true;
+    }
+
+    // 容器先放一个占位记号，结束时回填元素个数
+    bool parseContainer(int depth, bool object) {
+        if (depth >= kMaxDepth) return false;
+        ++mPos;
+        size_t index = mTokens.size();
+        mTokens.push_back({object ? JsonToken::Kind::Object : JsonToken::Kind::Array, false, 0, {}});
+        char close = object ? '}' : ']';
+
+        uint32_t count = 0;
+        if (!consume(close)) {
+            do {
+                if (object) {
+                    skipSpace();
+                    if (mPos >= mText.size() || mText[mPos] != '"' || !parseString() || !consume(':')) return false;
+                }
+                if (!parseValue(depth + 1)) return false;
+                ++count;
+            } while (consume(','));
+            if (!consume(close)) return false;
+        }
+        mTokens[index].count = count;
+        return true;
+    }
+
+    bool parseValue(int depth) {
+        skipSpace();
+        if (mPos >= mText.size()) return false;
+        switch (mText[mPos]) {
+        case '{': return parseContainer(depth, true);
+        case '[': return parseContainer(depth, false);
+        case '"': return parseString();
+        case 'n': return literal("null", JsonToken::Kind::Null);
+        case 't': return literal("true", JsonToken::Kind::True);
+        case 'f': return literal("false", JsonToken::Kind::False);
+        default: return parseNumber();
+        }
+    }
+
+    std::string_view mText;
+    std::vector<JsonToken>& mTokens;
+    size_t mPos = 0;
+};
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readHex4(std::string_view text, size_t pos, uint32_t& value) {
+    if (pos + 4 > text.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        int digit = hexDigit(text[i]);
+        if (digit < 0) return false;
+        value = (value << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// 还原字符串中的转义序列 (包括 \uXXXX 代理对)
+bool unescapeJson(std::string_view text, std::string& out) {
+    out.clear();
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\') {
+            out += text[i];
+            continue;
+        }
+        if (++i >= text.size()) return false;
+        switch (text[i]) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t codePoint = 0;
+            if (!readHex4(text, i + 1, codePoint)) return false;
+            i += 4;
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                uint32_t low = 0;
+                if (i + 2 >= text.size() || text[i + 1] != '\\' || text[i + 2] != 'u' ||
+                    !readHex4(text, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                i += 6;
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                return false;
+            }
+            appendUtf8(out, codePoint);
+            break;
+        }
+        default: return false;
+        }
+    }
+    return true;
+}
+
+// ==================== 编码 ====================
+
+void appendBigEndian(std::string& out, uint64_t value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+// 数字的三种编码形式
+struct JsonNumber {
+    enum class Kind : uint8_t { Unsigned, Negative, Double };
+
+    Kind kind = Kind::Unsigned;
+    uint64_t unsignedValue = 0;
+    int64_t signedValue = 0;
+    double doubleValue = 0;
+};
+
+// 整数优先按整数解析，超出 64 位范围或带小数/指数时按浮点数解析
+bool parseNumber(std::string_view text, JsonNumber& number) {
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+    if (text.find_first_of(".eE") == std::string_view::npos) {
+        if (text.front() == '-') {
+            auto [ptr, ec] = std::from_chars(begin, end, number.signedValue);
+            if (ec == std::errc() && ptr == end) {
+                number.kind = number.signedValue < 0 ? JsonNumber::Kind::Negative : JsonNumber::Kind::Unsigned;
+                number.unsignedValue = 0; // -0 按 0 编码
+                return true;
+            }
+        } else {
+            auto [ptr, ec] = std::from_chars(begin, end, number.unsignedValue);
+            if (ec == std::errc() && ptr == end) {
+                number.kind = JsonNumber::Kind::Unsigned;
+                return true;
+            }
+        }
+    }
+    auto [ptr, ec] = std::from_chars(begin, end, number.doubleValue);
+    number.kind = JsonNumber::Kind::Double;
+    return ec == std::errc() && ptr == end;
+}
+
+// MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md)
+class MessagePackEncoder {
+public:
+    explicit MessagePackEncoder(std::string& out) : mOut(out) {}
+
+    void null() { mOut += '\xC0'; }
+    void boolean(bool value) { mOut += value ? '\xC3' : '\xC2'; }
+
+    void number(const JsonNumber& number) {
+        switch (number.kind) {
+        case JsonNumber::Kind::Unsigned: unsignedInt(number.unsignedValue); break;
+        case JsonNumber::Kind::Negative: negativeInt(number.signedValue); break;
+        case JsonNumber::Kind::Double:
+            mOut += '\xCB';
+            appendBigEndian(mOut, std::bit_cast<uint64_t>(number.doubleValue), 8);
+            break;
+        }
+    }
+
+    void string(std::string_view value) {
+        size_t size = value.size();
+        if (size <= 31) {
+            mOut += static_cast<char>(0xA0 | size);
+        } else if (size <= 0xFF) {
+            mOut += '\xD9';
+            appendBigEndian(mOut, size, 1);
+        } else if (size <= 0xFFFF) {
+            mOut += '\xDA';
+            appendBigEndian(mOut, size, 2);
+        } else {
+            mOut += '\xDB';
+            appendBigEndian(mOut, size, 4);
+        }
+        mOut += value;
+    }
+
+    void array(uint32_t count) { container(count, 0x90, '\xDC', '\xDD'); }
+    void object(uint32_t count) { container(count, 0x80, '\xDE', '\xDF'); }
+
+private:
+    void unsignedInt(uint64_t value) {
+        if (value <= 0x7F) {
+            mOut += static_cast<char>(value);
+        } else if (value <= 0xFF) {
+            mOut += '\xCC';
+            appendBigEndian(mOut, value, 1);
+        } else if (value <= 0xFFFF) {
+            mOut += '\xCD';
+            appendBigEndian(mOut, value, 2);
+        } else if (value <= 0xFFFFFFFF) {
+            mOut += '\xCE';
+            appendBigEndian(mOut, value, 4);
+        } else {
+            mOut += '\xCF';
+            appendBigEndian(mOut, value, 8);
+        }
+    }
+
+    void negativeInt(int64_t value) {
+        auto bits = static_cast<uint64_t>(value);
+        if (value >= -32) {
+            mOut += static_cast<char>(bits & 0xFF);
+        } else if (value >= INT8_MIN) {
+            mOut += '\xD0';
+            appendBigEndian(mOut, bits, 1);
+        } else if (value >= INT16_MIN) {
+            mOut += '\xD1';
+            appendBigEndian(mOut, bits, 2);
+        } else if (value >= INT32_MIN) {
+            mOut += '\xD2';
+            appendBigEndian(mOut, bits, 4);
+        } else {
+            mOut += '\xD3';
+            appendBigEndian(mOut, bits, 8);
+        }
+    }
+
+    void container(uint32_t count, int fixPrefix, char prefix16, char prefix32) {
+        if (count <= 15) {
+            mOut += static_cast<char>(fixPrefix | count);
+        } else if (count <= 0xFFFF) {
+            mOut += prefix16;
+            appendBigEndian(mOut, count, 2);
+        } else {
+            mOut += prefix32;
+            appendBigEndian(mOut, count, 4);
+        }
+    }
+
+    std::string& mOut;
+};
+
+// CBOR (RFC 8949)，只使用定长的数组和映射
+class CborEncoder {
+public:
+    explicit CborEncoder(std::string& out) : mOut(out) {}
+
+    void null() { mOut += '\xF6'; }
+    void boolean(bool value) { mOut += value ? '\xF5' : '\xF4'; }
+
+    void number(const JsonNumber& number) {
+        switch (number.kind) {
+        case JsonNumber::Kind::Unsigned: head(0, number.unsignedValue); break;
+        // 负整数 n 编码为 -1 - n
+        case JsonNumber::Kind::Negative: head(1, ~static_cast<uint64_t>(number.signedValue)); break;
+        case JsonNumber::Kind::Double:
+            mOut += '\xFB';
+            appendBigEndian(mOut, std::bit_cast<uint64_t>(number.doubleValue), 8);
+            break;
+        }
+    }
+
+    void string(std::string_view value) {
+        head(3, value.size());
+        mOut += value;
+    }
+
+    void array(uint32_t count) { head(4, count); }
+    void object(uint32_t count) { head(5, count); }
+
+private:
+    void head(int major, uint64_t value) {
+        auto type = static_cast<char>(major << 5);
+        if (value < 24) {
+            mOut += static_cast<char>(type | static_cast<char>(value));
+        } else if (value <= 0xFF) {
+            mOut += static_cast<char>(type | 24);
+            appendBigEndian(mOut, value, 1);
+        } else if (value <= 0xFFFF) {
+            mOut += static_cast<char>(type | 25);
+            appendBigEndian(mOut, value, 2);
+        } else if (value <= 0xFFFFFFFF) {
+            mOut += static_cast<char>(type | 26);
+            appendBigEndian(mOut, value, 4);
+        } else {
+            mOut += static_cast<char>(type | 27);
+            appendBigEndian(mOut, value, 8);
+        }
+    }
+
+    std::string& mOut;
+};
+
+template <typename Encoder>
+bool encodeTokens(const std::vector<JsonToken>& tokens, Encoder& encoder) {
+    std::string scratch;
+    for (const auto& token : tokens) {
+        switch (token.kind) {
+        case JsonToken::Kind::Null: encoder.null(); break;
+        case JsonToken::Kind::False: encoder.boolean(false); break;
+        case JsonToken::Kind::True: encoder.boolean(true); break;
+        case JsonToken::Kind::Array: encoder.array(token.count); break;
+        case JsonToken::Kind::Object: encoder.object(token.count); break;
+        case JsonToken::Kind::Number: {
+            JsonNumber number;
+            if (!parseNumber(token.text, number)) return false;
+            encoder.number(number);
+            break;
+        }
+        case JsonToken::Kind::String:
+            if (!token.escaped) {
+                encoder.string(token.text);
+            } else {
+                if (!unescapeJson(token.text, scratch)) return false;
+                encoder.string(scratch);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+} // namespace
+
+const char* bodyFormatContentType(BodyFormat format) {
+    switch (format) {
+    case BodyFormat::MessagePack: return "application/msgpack";
+    case BodyFormat::Cbor: return "application/cbor";
+    default: return "application/json; charset=utf-8";
+    }
+}
+
+std::string_view bodyFormatTag(BodyFormat format) {
+    switch (format) {
+    case BodyFormat::MessagePack: return "-msgpack";
+    case BodyFormat::Cbor: return "-cbor";
+    default: return {};
+    }
+}
+
+BodyFormat negotiateBodyFormat(std::string_view accept) {
+    // 每种格式的 q 值 (千分之一)，-1 表示未出现
+    std::array<int, static_cast<size_t>(BodyFormat::Count_)> quality;
+    quality.fill(-1);
+    int wildcard = -1;
+
+    while (!accept.empty()) {
+        size_t comma = accept.find(',');
+        std::string_view item = accept.substr(0, comma);
+        accept = comma == std::string_view::npos ? std::string_view{} : accept.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view type = trim(item.substr(0, semicolon));
+        int q = semicolon == std::string_view::npos ? 1000 : parseQValue(item.substr(semicolon + 1));
+
+        if (type == "*/*" || equalsIgnoreCase(type, "application/*")) {
+            wildcard = std::max(wildcard, q);
+        } else if (equalsIgnoreCase(type, "application/json")) {
+            quality[static_cast<size_t>(BodyFormat::Json)] = q;
+        } else if (equalsIgnoreCase(type, "application/msgpack") || equalsIgnoreCase(type, "application/x-msgpack") ||
+                   equalsIgnoreCase(type, "application/vnd.msgpack")) {
+            quality[static_cast<size_t>(BodyFormat::MessagePack)] = q;
+        } else if (equalsIgnoreCase(type, "application/cbor")) {
+            quality[static_cast<size_t>(BodyFormat::Cbor)] = q;
+        }
+    }
+
+    // 通配符只代表 JSON：二进制格式必须被显式列出；q 值与 JSON 相同时二进制格式优先 (客户端解析更省)，
+    // 两种二进制格式之间只有 q 值更高才替换，相同时保留先检查的 MessagePack
+    int jsonQuality = quality[static_cast<size_t>(BodyFormat::Json)];
+    if (jsonQuality < 0) jsonQuality = wildcard;
+    BodyFormat best = BodyFormat::Json;
+    int bestQuality = std::max(jsonQuality, 0);
+    for (auto format : {BodyFormat::MessagePack, BodyFormat::Cbor}) {
+        int q = quality[static_cast<size_t>(format)];
+        if (q > 0 && q >= bestQuality && (best == BodyFormat::Json || q > bestQuality)) {
+            best = format;
+            bestQuality = q;
+        }
+    }
+    return best;
+}
+
+bool transcodeJson(std::string_view json, BodyFormat format, std::string& output) {
+    std::vector<JsonToken> tokens;
+    tokens.reserve(json.size() / 8 + 4);
+    if (!JsonTokenizer(json, tokens).run()) {
+        return false;
+    }
+
+    // 二进制编码通常比 JSON 小，按原长度预留即可
+    output.clear();
+    output.reserve(json.size());
+    switch (format) {
+    case BodyFormat::MessagePack: {
+        MessagePackEncoder encoder(output);
+        return encodeTokens(tokens, encoder);
+    }
+    case BodyFormat::Cbor: {
+        CborEncoder encoder(output);
+        return encodeTokens(tokens, encoder);
+    }
+    default: return false;
+    }
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace serverinfo_rest {
+
+// 响应体格式，二进制格式与 JSON 输出使用相同的字段结构
+enum class BodyFormat : uint8_t {
+    Json,
+    MessagePack,
+    Cbor,
+    Count_
+};
+
+// Content-Type 头中使用的媒体类型
+const char* bodyFormatContentType(BodyFormat format);
+
+// ETag 中区分格式的后缀，JSON 为空
+std::string_view bodyFormatTag(BodyFormat format);
+
+// 根据 Accept 选择格式：显式列出的 MessagePack / CBOR 的 q 值不低于 JSON 时切换 (相同时二进制格式优先，
+// 两种二进制格式相同时选 MessagePack)；通配符只代表 JSON，没有 Accept 头时返回 Json
+BodyFormat negotiateBodyFormat(std::string_view accept);
+
+// 把 JSON 文本逐个记号转换为 MessagePack 或 CBOR，不构建中间 DOM；输入不是合法 JSON 时返回 false
+// 整数按最短形式编码，带小数点或指数的数字编码为 64 位浮点数
+bool transcodeJson(std::string_view json, BodyFormat format, std::string& output);
+
+} // namespace serverinfo_rest
@@ -0,0 +1,198 @@
+#include "mod/Compression.h"
+
+#include <brotli/encode.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace serverinfo_rest {
+
+namespace {
+
+// gzip/deflate 使用 zlib 默认级别；brotli 的 5 级速度与 gzip 默认级别相当，压缩率更高
+constexpr int kZlibLevel = Z_DEFAULT_COMPRESSION;
+constexpr int kBrotliQuality = 5;
+
+bool compressZlib(std::string_view input, std::string& output, bool gzip) {
+    z_stream stream{};
+    // windowBits 加 16 输出 gzip 头尾，否则为 zlib 格式
+    if (deflateInit2(&stream, kZlibLevel, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+bool compressBrotli(std::string_view input, std::string& output) {
+    size_t size = BrotliEncoderMaxCompressedSize(input.size());
+    if (size == 0) {
+        return false;
+    }
+    output.resize(size);
+    if (!BrotliEncoderCompress(kBrotliQuality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, input.size(),
+                               reinterpret_cast<const uint8_t*>(input.data()), &size,
+                               reinterpret_cast<uint8_t*>(output.data()))) {
+        return false;
+    }
+    output.resize(size);
+    return true;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int parseQValue(std::string_view params) {
+    while (!params.empty()) {
+        size_t semicolon = params.find(';');
+        std::string_view param = trim(params.substr(0, semicolon));
+        params = semicolon == std::string_view::npos ? std::string_view{} : params.substr(semicolon + 1);
+        if (param.size() < 2 || std::tolower(static_cast<unsigned char>(param[0])) != 'q' || param[1] != '=') {
+            continue;
+        }
+        std::string_view value = param.substr(2);
+        int integer = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), integer);
+        if (ec != std::errc() || integer < 0 || integer > 1) {
+            return 1000;
+        }
+        int result = integer * 1000;
+        if (ptr != value.data() + value.size() && *ptr == '.') {
+            int scale = 100;
+            for (++ptr; ptr != value.data() + value.size() && scale > 0; ++ptr, scale /= 10) {
+                if (*ptr < '0' || *ptr > '9') break;
+                result += (*ptr - '0') * scale;
+            }
+        }
+        return std::min(result, 1000);
+    }
+    return 1000;
+}
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+    case ContentEncoding::Gzip: return "gzip";
+    case ContentEncoding::Deflate: return "deflate";
+    case ContentEncoding::Brotli: return "br";
+    default: return "identity";
+    }
+}
+
+std::string_view contentEncodingTag(ContentEncoding encoding) {
+    switch (encoding) {
+    case ContentEncoding::Gzip: return "-gzip";
+    case ContentEncoding::Deflate: return "-deflate";
+    case ContentEncoding::Brotli: return "-br";
+    default: return {};
+    }
+}
+
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding) {
+    // 每种编码的 q 值 (千分之一)，-1 表示未出现
+    std::array<int, static_cast<size_t>(ContentEncoding::Count_)> quality;
+    quality.fill(-1);
+    int wildcard = -1;
+
+    while (!acceptEncoding.empty()) {
+        size_t comma = acceptEncoding.find(',');
+        std::string_view item = acceptEncoding.substr(0, comma);
+        acceptEncoding = comma == std::string_view::npos ? std::string_view{} : acceptEncoding.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        int q = semicolon == std::string_view::npos ? 1000 : parseQValue(item.substr(semicolon + 1));
+
+        if (coding == "*") {
+            wildcard = q;
+        } else if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip")) {
+            quality[static_cast<size_t>(ContentEncoding::Gzip)] = q;
+        } else if (equalsIgnoreCase(coding, "deflate")) {
+            quality[static_cast<size_t>(ContentEncoding::Deflate)] = q;
+        } else if (equalsIgnoreCase(coding, "br")) {
+            quality[static_cast<size_t>(ContentEncoding::Brotli)] = q;
+        }
+    }
+
+    // 按偏好顺序比较，q 值相同时选择更靠前的编码
+    ContentEncoding best = ContentEncoding::Identity;
+    int bestQuality = 0;
+    for (auto encoding : {ContentEncoding::Brotli, ContentEncoding::Gzip, ContentEncoding::Deflate}) {
+        int q = quality[static_cast<size_t>(encoding)];
+        if (q < 0) q = wildcard;
+        if (q > bestQuality) {
+            best = encoding;
+            bestQuality = q;
+        }
+    }
+    return best;
+}
+
+bool compressBody(ContentEncoding encoding, std::string_view input, std::string& output) {
+    switch (encoding) {
+    case ContentEncoding::Gzip: return compressZlib(input, output, true);
+    case ContentEncoding::Deflate: return compressZlib(input, output, false);
+    case ContentEncoding::Brotli: return compressBrotli(input, output);
+    default: return false;
+    }
+}
+
+// ==================== EncodedBody ====================
+
+std::shared_ptr<const std::string> EncodedBody::encoded(ContentEncoding encoding) const {
+    auto index = static_cast<size_t>(encoding);
+    if (encoding == ContentEncoding::Identity || index >= kEncodings) {
+        return nullptr;
+    }
+
+    // 同一时刻多个请求需要同一种编码时，只有一个线程压缩，其余等待结果；
+    // 每种编码各自一个 once_flag，压缩 brotli 时不会挡住 gzip 或已经生成的编码
+    std::call_once(mEncodedOnce[index], [&] {
+        std::string output;
+        if (compressBody(encoding, mIdentity, output) && output.size() < mIdentity.size()) {
+            mEncoded[index] = std::make_shared<const std::string>(std::move(output));
+        }
+    });
+    return mEncoded[index];
+}
+
+std::shared_ptr<const EncodedBody> EncodedBody::transcoded(BodyFormat format) const {
+    auto index = static_cast<size_t>(format);
+    if (format == BodyFormat::Json || index >= kFormats) {
+        return nullptr;
+    }
+
+    std::call_once(mFormatOnce[index], [&] {
+        std::string output;
+        if (transcodeJson(mIdentity, format, output)) {
+            mFormats[index] = std::make_shared<const EncodedBody>(std::move(output));
+        }
+    });
+    return mFormats[index];
+}
+
+} // namespace serverinfo_rest
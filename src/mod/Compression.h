@@ -0,0 +1,64 @@
+#pragma once
+
+#include "mod/BinaryFormat.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace serverinfo_rest {
+
+// 支持的内容编码
+enum class ContentEncoding : uint8_t {
+    Identity,
+    Gzip,
+    Deflate, // zlib 格式 (RFC 9110 8.4.1.2)
+    Brotli,
+    Count_
+};
+
+// 解析 Accept / Accept-Encoding 条目参数中的 q 值 (0 ~ 1，最多三位小数)，按千分之一返回；格式错误视为 1
+int parseQValue(std::string_view params);
+
+// Content-Encoding 头中使用的名称
+const char* contentEncodingName(ContentEncoding encoding);
+
+// ETag 中区分编码的后缀 (在格式后缀之后)，Identity 为空
+std::string_view contentEncodingTag(ContentEncoding encoding);
+
+// 根据 Accept-Encoding 选择编码：取 q 值最高的，相同时按 br > gzip > deflate，都不接受时返回 Identity
+ContentEncoding negotiateEncoding(std::string_view acceptEncoding);
+
+// 压缩 input，失败时返回 false
+bool compressBody(ContentEncoding encoding, std::string_view input, std::string& output);
+
+// 预序列化的共享响应体，同时缓存按需生成的其他格式和压缩版本，同一份内容每种格式、每种编码只生成一次
+class EncodedBody {
+public:
+    explicit EncodedBody(std::string identity) : mIdentity(std::move(identity)) {}
+
+    [[nodiscard]] const std::string& identity() const { return mIdentity; }
+
+    // 返回指定编码的压缩结果 (第一次调用时生成)；压缩失败或没有变小时返回 nullptr
+    [[nodiscard]] std::shared_ptr<const std::string> encoded(ContentEncoding encoding) const;
+
+    // 返回转换为 MessagePack / CBOR 的响应体 (第一次调用时生成，自身也缓存压缩版本)；转换失败时返回 nullptr
+    [[nodiscard]] std::shared_ptr<const EncodedBody> transcoded(BodyFormat format) const;
+
+private:
+    static constexpr size_t kEncodings = static_cast<size_t>(ContentEncoding::Count_);
+    static constexpr size_t kFormats = static_cast<size_t>(BodyFormat::Count_);
+
+    std::string mIdentity;
+    // 每个槽位只生成一次，call_once 返回后槽位只读，读取不需要加锁
+    mutable std::array<std::once_flag, kEncodings> mEncodedOnce;
+    mutable std::array<std::shared_ptr<const std::string>, kEncodings> mEncoded;
+    mutable std::array<std::once_flag, kFormats> mFormatOnce;
+    mutable std::array<std::shared_ptr<const EncodedBody>, kFormats> mFormats;
+};
+
+} // namespace serverinfo_rest
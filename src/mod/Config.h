@@ -23,6 +23,68 @@ struct Config {
     // Token 认证配置
     bool enableToken = false;  // 是否启用 token 验证
     std::string token = "";    // 访问令牌，启用后需要在请求中附带 ?token=xxx
+
+    // 工作线程池配置
+    int workerThreads = 0;     // 处理请求的工作线程数，0 表示使用 CPU 核心数
+    int workerQueueSize = 64;  // 等待处理的连接队列上限，队列满时直接返回 503
+
+    // 连接准入配置
+    int maxConnections = 1024; // 同时打开的连接数上限 (含 SSE 和 WebSocket)，超出的新连接返回 503 后关闭，0 表示不限制
+    int acceptBacklog = 128;   // 内核中等待 accept 的连接队列长度，0 表示使用系统默认值 (SOMAXCONN)
+
+    // HTTP keep-alive 配置
+    bool enableKeepAlive = true;     // 是否允许持久连接 (HTTP/1.1 默认开启)
+    int keepAliveTimeout = 5000;     // 连接空闲超时 (毫秒)，超时未收到新请求则关闭
+    int keepAliveMaxRequests = 100;  // 单个连接最多处理的请求数，达到后关闭连接
+
+    // 连接超时配置 (毫秒，0 表示不限制)；请求超时从开始接收时计算，期间收到数据不会续期
+    int headerTimeout = 5000;   // 接收请求行和请求头的时限，超时返回 408
+    int bodyTimeout = 10000;    // 接收请求体的时限，超时返回 408
+    int writeTimeout = 10000;   // 发送一个响应的时限，客户端不读取时关闭连接
+
+    // Server-Sent Events 配置 (GET /api/v1/events)
+    int sseHistorySize = 256;          // 保留最近的事件数，用于 Last-Event-ID 断线续传
+    int sseMaxQueuedEvents = 256;      // 单个订阅者最多积压的事件数，超过后断开该订阅者
+    int sseHeartbeatInterval = 15000;  // 没有事件时发送心跳的间隔 (毫秒)
+
+    // 玩家状态采样 (坐标、维度、血量、延迟)
+    int sampleIntervalTicks = 10;      // 每隔多少游戏刻采样一次 (20 刻 = 1 秒)，0 表示禁用
+
+    // 游戏线程查询配置 (需要实时游戏数据的端点，例如 /server 的 levelName)
+    int gameQueryTimeout = 1000;       // 等待游戏线程返回结果的时限 (毫秒)，超时返回 504
+    int gameQueryMaxPending = 64;      // 同一刻内最多排队的不同查询数，超过时返回 503
+
+    // WebSocket 配置 (GET /api/v1/ws)
+    int wsPingInterval = 20000;        // 发送 ping 的间隔 (毫秒)，两个间隔内没有收到任何数据则断开
+    int wsSendBufferLimit = 262144;    // 单个连接待发送字节数上限，超过后暂停推送并合并增量
+
+    // 响应压缩 (按 Accept-Encoding 选择 br / gzip / deflate)
+    bool enableCompression = true;     // 是否压缩响应体
+    int compressionMinSize = 1024;     // 小于该字节数的响应体不压缩
+
+    // 响应格式 (按 Accept 选择 JSON / MessagePack / CBOR)
+    bool enableBinaryFormats = true;   // 是否按 Accept 输出 MessagePack / CBOR
+
+    // 批量请求 (POST /api/v1/batch)
+    int batchMaxRequests = 32;         // 单个批量请求最多包含的子请求数
+
+    // 限流 (令牌桶，超限返回 429 Too Many Requests)
+    bool enableRateLimit = false;      // 是否启用限流 (高优先级路由 /health、/players/count 不受限流)
+    int rateLimitPerIp = 20;           // 每个 IP 每秒允许的请求数，0 表示不按 IP 限流
+    int rateLimitIpBurst = 40;         // 每个 IP 允许的突发请求数
+    int rateLimitPerToken = 50;        // 每个 token 每秒允许的请求数，0 表示不按 token 限流
+    int rateLimitTokenBurst = 100;     // 每个 token 允许的突发请求数
+    // 最多同时跟踪的客户端数。表满时新客户端完全不受限流 (fail-open)：
+    // 来自大量不同 IP 的洪水可以借此绕过限流，此时应依靠 maxConnections / workerQueueSize 兜底
+    int rateLimitMaxClients = 4096;
+    int rateLimitIdleTimeout = 60000;  // 客户端闲置多久后回收其令牌桶 (毫秒)
+
+    // 调试
+    bool enableDebugStats = false;     // 统计各处理阶段的延迟分布，并开放 GET /api/v1/debug/stats
+
+    // 日志
+    bool asyncLogging = false;         // 由后台线程输出日志，请求线程和游戏线程不等待日志 I/O
+    int asyncLogQueueSize = 8192;      // 异步日志队列长度 (向上取整为 2 的幂)，队列满时丢弃新消息
 };
 
 } // namespace serverinfo_rest
@@ -0,0 +1,49 @@
+#include "mod/EventStream.h"
+
+#include <algorithm>
+
+namespace serverinfo_rest {
+
+EventStream::EventStream(size_t capacity) : mRing(capacity == 0 ? 1 : capacity) {}
+
+uint64_t EventStream::publish(std::string_view type, std::string_view data) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    uint64_t id = ++mLastId;
+
+    // 在锁内格式化只是为了拿到 ID，帧很小，开销可以忽略
+    std::string frame;
+    frame.reserve(type.size() + data.size() + 40);
+    frame += "id: ";
+    frame += std::to_string(id);
+    frame += "\nevent: ";
+    frame += type;
+    frame += "\ndata: ";
+    frame += data;
+    frame += "\n\n";
+
+    auto& entry = mRing[id % mRing.size()];
+    entry.id = id;
+    entry.frame = std::make_shared<const std::string>(std::move(frame));
+    return id;
+}
+
+bool EventStream::collectSince(uint64_t afterId, std::vector<StreamEvent>& out) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (afterId >= mLastId) {
+        return true;
+    }
+
+    uint64_t oldest = mLastId >= mRing.size() ? mLastId - mRing.size() + 1 : 1;
+    bool complete = afterId + 1 >= oldest;
+    for (uint64_t id = std::max(afterId + 1, oldest); id <= mLastId; ++id) {
+        out.push_back(mRing[id % mRing.size()]);
+    }
+    return complete;
+}
+
+uint64_t EventStream::lastId() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLastId;
+}
+
+} // namespace serverinfo_rest
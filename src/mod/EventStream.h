@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 已格式化好的 SSE 事件帧 ("id: ...\nevent: ...\ndata: ...\n\n")，所有订阅者共享同一份
+using EventFrame = std::shared_ptr<const std::string>;
+
+struct StreamEvent {
+    uint64_t id = 0;
+    EventFrame frame;
+};
+
+// 最近事件的环形缓冲区，用于 SSE 的扇出和 Last-Event-ID 断线续传
+// publish() 可以在任意线程调用 (通常是游戏线程)，只做一次格式化和一次短暂加锁的写入，
+// 不会等待任何订阅者。
+class EventStream {
+public:
+    explicit EventStream(size_t capacity);
+
+    // 发布事件，返回分配的事件 ID (从 1 开始递增)
+    uint64_t publish(std::string_view type, std::string_view data);
+
+    // 取出 ID 大于 afterId 的所有事件，返回 false 表示其中一部分已经被覆盖 (订阅者丢失了事件)
+    bool collectSince(uint64_t afterId, std::vector<StreamEvent>& out) const;
+
+    [[nodiscard]] uint64_t lastId() const;
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<StreamEvent> mRing;
+    uint64_t mLastId = 0;
+};
+
+} // namespace serverinfo_rest
@@ -0,0 +1,65 @@
+#include "mod/GameQueryExecutor.h"
+
+#include <stdexcept>
+
+namespace serverinfo_rest {
+
+GameQueryExecutor::GameQueryExecutor(size_t maxPending) : mMaxPending(maxPending > 0 ? maxPending : 1) {}
+
+GameQueryStatus GameQueryExecutor::submit(const std::string& key, GameQueryFn query,
+                                          std::shared_future<std::string>& future) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mStopped.load(std::memory_order_relaxed)) {
+        return GameQueryStatus::Stopped;
+    }
+    auto it = mPending.find(key);
+    if (it != mPending.end()) {
+        mMerged.fetch_add(1, std::memory_order_relaxed);
+        future = it->second.future;
+        return GameQueryStatus::Merged;
+    }
+    if (mPending.size() >= mMaxPending) {
+        mRejected.fetch_add(1, std::memory_order_relaxed);
+        return GameQueryStatus::Full;
+    }
+    PendingQuery& pending = mPending[key];
+    pending.query = std::move(query);
+    pending.future = pending.promise.get_future().share();
+    future = pending.future;
+    mHasPending.store(true, std::memory_order_release);
+    return GameQueryStatus::Queued;
+}
+
+size_t GameQueryExecutor::runPending() {
+    std::unordered_map<std::string, PendingQuery> batch;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        batch.swap(mPending);
+        // 执行期间到达的查询留到下一刻
+        mHasPending.store(false, std::memory_order_relaxed);
+    }
+    for (auto& [key, pending] : batch) {
+        try {
+            pending.promise.set_value(pending.query());
+        } catch (...) {
+            pending.promise.set_exception(std::current_exception());
+        }
+    }
+    mExecuted.fetch_add(batch.size(), std::memory_order_relaxed);
+    return batch.size();
+}
+
+void GameQueryExecutor::shutdown() {
+    std::unordered_map<std::string, PendingQuery> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopped.store(true, std::memory_order_release);
+        abandoned.swap(mPending);
+        mHasPending.store(false, std::memory_order_relaxed);
+    }
+    for (auto& [key, pending] : abandoned) {
+        pending.promise.set_exception(std::make_exception_ptr(std::runtime_error("Game query executor stopped")));
+    }
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace serverinfo_rest {
+
+// 在游戏线程中执行的查询，结果序列化为字符串 (通常是 JSON 片段)
+using GameQueryFn = std::function<std::string()>;
+
+// 提交查询的结果
+enum class GameQueryStatus : uint8_t {
+    Queued,  // 已排队，等待下一刻执行
+    Merged,  // 与同一刻内 key 相同的查询合并，共享其结果
+    Full,    // 待处理的查询已达上限
+    Stopped  // 执行器已停止 (插件正在禁用)
+};
+
+// 把工作线程对实时游戏数据的查询交给游戏线程执行
+// 工作线程提交查询后通过 future 等待结果 (由调用方决定超时)；同一刻内 key 相同的查询合并为一次执行。
+// 游戏线程每刻调用一次 runPending()，一次执行所有待处理的查询，
+// 因此无论 HTTP 负载多高，每刻最多执行一批，且每批最多 maxPending 个查询。
+class GameQueryExecutor {
+public:
+    explicit GameQueryExecutor(size_t maxPending);
+
+    GameQueryExecutor(const GameQueryExecutor&) = delete;
+    GameQueryExecutor& operator=(const GameQueryExecutor&) = delete;
+
+    // 任意线程：提交查询，key 相同且尚未执行的查询共享同一个结果
+    // 返回 Queued / Merged 时 future 有效，否则不修改 future
+    GameQueryStatus submit(const std::string& key, GameQueryFn query, std::shared_future<std::string>& future);
+
+    // 游戏线程 (每刻)：是否有待处理的查询，没有时不必调用 runPending()
+    [[nodiscard]] bool hasPending() const { return mHasPending.load(std::memory_order_acquire); }
+
+    // 游戏线程 (每刻)：执行所有待处理的查询，返回执行的数量；查询抛出的异常会传给等待的 future
+    size_t runPending();
+
+    // 停止接收查询，尚未执行的查询以异常结束，等待中的线程立即返回
+    void shutdown();
+    [[nodiscard]] bool stopped() const { return mStopped.load(std::memory_order_acquire); }
+
+    // 统计 (用于指标)
+    [[nodiscard]] uint64_t executedCount() const { return mExecuted.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t mergedCount() const { return mMerged.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t rejectedCount() const { return mRejected.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingQuery {
+        GameQueryFn query;
+        std::promise<std::string> promise;
+        std::shared_future<std::string> future;
+    };
+
+    size_t mMaxPending;
+
+    std::mutex mMutex;
+    std::unordered_map<std::string, PendingQuery> mPending;
+    std::atomic<bool> mHasPending{false}; // mPending 非空，游戏线程据此跳过空闲的刻
+    std::atomic<bool> mStopped{false};
+
+    std::atomic<uint64_t> mExecuted{0};
+    std::atomic<uint64_t> mMerged{0};
+    std::atomic<uint64_t> mRejected{0};
+};
+
+} // namespace serverinfo_rest
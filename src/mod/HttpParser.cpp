@@ -0,0 +1,245 @@
+#include "mod/HttpParser.h"
+
+#include <charconv>
+
+namespace serverinfo_rest {
+
+static char toLowerAscii(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+static std::string_view trimSpaces(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (toLowerAscii(a[i]) != toLowerAscii(b[i])) return false;
+    }
+    return true;
+}
+
+std::string percentDecode(std::string_view input, bool plusAsSpace) {
+    std::string result;
+    result.reserve(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        char c = input[i];
+        if (c == '%' && i + 2 < input.size()) {
+            int hi = hexValue(input[i + 1]);
+            int lo = hexValue(input[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                result.push_back(static_cast<char>((hi << 4) | lo));
+                i += 2;
+                continue;
+            }
+        }
+        result.push_back(plusAsSpace && c == '+' ? ' ' : c);
+    }
+    return result;
+}
+
+void parseQueryString(std::string_view query, QueryParams& params) {
+    while (!query.empty()) {
+        size_t ampPos = query.find('&');
+        std::string_view pair = query.substr(0, ampPos);
+        query = ampPos == std::string_view::npos ? std::string_view{} : query.substr(ampPos + 1);
+        if (pair.empty()) {
+            continue;
+        }
+
+        size_t eqPos = pair.find('=');
+        std::string key = percentDecode(pair.substr(0, eqPos));
+        std::string value = eqPos == std::string_view::npos ? std::string{} : percentDecode(pair.substr(eqPos + 1));
+        // 重复的参数保留第一个，与原先逐个查找时的行为一致
+        params.try_emplace(std::move(key), std::move(value));
+    }
+}
+
+std::string_view HttpRequest::getHeader(std::string_view name) const {
+    for (const auto& header : headers) {
+        if (equalsIgnoreCase(header.name, name)) {
+            return header.value;
+        }
+    }
+    return {};
+}
+
+std::string_view HttpRequest::getParam(std::string_view key) const {
+    auto it = params.find(key);
+    return it != params.end() ? std::string_view(it->second) : std::string_view{};
+}
+
+// ==================== 解析器状态机 ====================
+
+void HttpParser::reset() {
+    mState = State::RequestLine;
+    mScanPos = 0;
+    mLineStart = 0;
+    mBodyStart = 0;
+    mContentLength = 0;
+    mConsumed = 0;
+    mMethod = mTarget = mVersion = {};
+    mHeaders.clear();
+    mErrorStatus = 0;
+    mErrorText = "";
+}
+
+HttpParser::Result HttpParser::fail(int status, const char* text) {
+    mState = State::Failed;
+    mErrorStatus = status;
+    mErrorText = text;
+    return Result::Error;
+}
+
+HttpParser::Result HttpParser::parse(std::string_view buffer, HttpRequest& request) {
+    while (true) {
+        switch (mState) {
+        case State::RequestLine:
+        case State::Headers: {
+            size_t eol = buffer.find('\n', mScanPos);
+            if (eol == std::string_view::npos) {
+                mScanPos = buffer.size();
+                if (buffer.size() > mLimits.maxHeaderBytes) {
+                    return fail(431, "Request Header Fields Too Large");
+                }
+                return Result::Incomplete;
+            }
+            if (eol >= mLimits.maxHeaderBytes) {
+                return fail(431, "Request Header Fields Too Large");
+            }
+
+            size_t lineBegin = mLineStart;
+            size_t lineEnd = (eol > lineBegin && buffer[eol - 1] == '\r') ? eol - 1 : eol;
+            mLineStart = mScanPos = eol + 1;
+
+            if (mState == State::RequestLine) {
+                // 容忍请求之前多余的空行 (RFC 9112 2.2)
+                if (lineEnd == lineBegin) {
+                    continue;
+                }
+                if (!parseRequestLine(buffer, lineBegin, lineEnd)) {
+                    return fail(400, "Bad Request");
+                }
+                mState = State::Headers;
+            } else if (lineEnd == lineBegin) {
+                mBodyStart = mLineStart;
+                mState = State::Body;
+            } else if (!parseHeaderLine(buffer, lineBegin, lineEnd)) {
+                return Result::Error;
+            }
+            break;
+        }
+
+        case State::Body:
+            if (buffer.size() - mBodyStart < mContentLength) {
+                return Result::Incomplete;
+            }
+            mConsumed = mBodyStart + mContentLength;
+            mState = State::Done;
+            [[fallthrough]];
+
+        case State::Done: {
+            auto view = [&buffer](Span span) { return buffer.substr(span.offset, span.length); };
+
+            std::string_view target = view(mTarget);
+            size_t queryPos = target.find('?');
+            request.method = view(mMethod);
+            request.version = view(mVersion);
+            request.path = target.substr(0, queryPos);
+            request.query = queryPos == std::string_view::npos ? std::string_view{} : target.substr(queryPos + 1);
+            request.body = buffer.substr(mBodyStart, mContentLength);
+
+            request.headers.clear();
+            request.headers.reserve(mHeaders.size());
+            for (const auto& header : mHeaders) {
+                request.headers.push_back({view(header.name), view(header.value)});
+            }
+
+            request.params.clear();
+            parseQueryString(request.query, request.params);
+            return Result::Complete;
+        }
+
+        case State::Failed:
+            return Result::Error;
+        }
+    }
+}
+
+bool HttpParser::parseRequestLine(std::string_view buffer, size_t begin, size_t end) {
+    std::string_view line = buffer.substr(begin, end - begin);
+
+    size_t methodEnd = line.find(' ');
+    if (methodEnd == std::string_view::npos || methodEnd == 0) {
+        return false;
+    }
+    size_t targetEnd = line.find(' ', methodEnd + 1);
+    if (targetEnd == std::string_view::npos || targetEnd == methodEnd + 1) {
+        return false;
+    }
+
+    std::string_view version = line.substr(targetEnd + 1);
+    if (version.substr(0, 5) != "HTTP/") {
+        return false;
+    }
+
+    auto span = [begin](size_t offset, size_t length) {
+        return Span{static_cast<uint32_t>(begin + offset), static_cast<uint32_t>(length)};
+    };
+    mMethod = span(0, methodEnd);
+    mTarget = span(methodEnd + 1, targetEnd - methodEnd - 1);
+    mVersion = span(targetEnd + 1, version.size());
+    return true;
+}
+
+bool HttpParser::parseHeaderLine(std::string_view buffer, size_t begin, size_t end) {
+    if (mHeaders.size() >= mLimits.maxHeaderCount) {
+        fail(431, "Request Header Fields Too Large");
+        return false;
+    }
+
+    std::string_view line = buffer.substr(begin, end - begin);
+    size_t colonPos = line.find(':');
+    if (colonPos == std::string_view::npos || colonPos == 0) {
+        fail(400, "Bad Request");
+        return false;
+    }
+
+    std::string_view name = line.substr(0, colonPos);
+    std::string_view value = trimSpaces(line.substr(colonPos + 1));
+    size_t valueOffset = static_cast<size_t>(value.data() - buffer.data());
+
+    if (equalsIgnoreCase(name, "Content-Length")) {
+        size_t length = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+        if (ec != std::errc() || ptr != value.data() + value.size()) {
+            fail(400, "Bad Request");
+            return false;
+        }
+        if (length > mLimits.maxBodyBytes) {
+            fail(413, "Payload Too Large");
+            return false;
+        }
+        mContentLength = length;
+    } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+        // 本服务器的接口都不需要分块上传
+        fail(501, "Not Implemented");
+        return false;
+    }
+
+    mHeaders.push_back({
+        {static_cast<uint32_t>(begin), static_cast<uint32_t>(colonPos)},
+        {static_cast<uint32_t>(valueOffset), static_cast<uint32_t>(value.size())}
+    });
+    return true;
+}
+
+} // namespace serverinfo_rest
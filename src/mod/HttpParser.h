@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serverinfo_rest {
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// 路由匹配出的路径参数，例如 /player/{name} 中的 name
+struct PathParam {
+    std::string_view name;
+    std::string_view value; // 原始值 (未做百分号解码)
+};
+
+// 固定容量的路径参数列表，路由匹配时不分配内存
+struct PathParams {
+    static constexpr size_t kCapacity = 8;
+    std::array<PathParam, kCapacity> items{};
+    size_t count = 0;
+    
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (items[i].name == name) return items[i].value;
+        }
+        return {};
+    }
+};
+
+// 解码后的 query 参数 (支持以 string_view 查找)
+using QueryParams = std::map<std::string, std::string, std::less<>>;
+
+// HTTP 请求
+// method/path/query/version/headers/body 都是指向连接接收缓冲区的视图，
+// 只在请求处理期间有效；params 是解码后的独立副本
+struct HttpRequest {
+    std::string_view method;
+    std::string_view path;
+    std::string_view query;
+    std::string_view version;
+    std::vector<HttpHeader> headers;
+    std::string_view body;
+    QueryParams params;
+    PathParams pathParams; // 由路由器在分发时填充
+    
+    // 按名称查找头部 (不区分大小写)，不存在时返回空视图
+    std::string_view getHeader(std::string_view name) const;
+    
+    // 查找 query 参数 (已做百分号解码)，不存在时返回空视图
+    std::string_view getParam(std::string_view key) const;
+    
+    // 查找路径参数 (原始值)，不存在时返回空视图
+    std::string_view getPathParam(std::string_view name) const { return pathParams.get(name); }
+};
+
+// 解析 a=1&b=%20x 形式的 query string，结果追加到 params (已存在的键不覆盖)
+void parseQueryString(std::string_view query, QueryParams& params);
+
+// 百分号解码，plusAsSpace 为 true 时把 '+' 解码为空格 (application/x-www-form-urlencoded)
+std::string percentDecode(std::string_view input, bool plusAsSpace = true);
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+// 增量式 HTTP/1.x 请求解析器 (状态机)
+// 每次收到新数据后用完整的连接缓冲区调用 parse()，解析器会从上次停下的位置继续，
+// 已扫描过的字节不会重复扫描。解析过程中只记录偏移量，完成时才生成指向缓冲区的视图，
+// 所以两次调用之间缓冲区可以扩容。
+class HttpParser {
+public:
+    enum class Result { Incomplete, Complete, Error };
+
+    struct Limits {
+        size_t maxHeaderBytes = 16 * 1024; // 请求行 + 所有头部的最大字节数
+        size_t maxHeaderCount = 64;
+        size_t maxBodyBytes = 64 * 1024;
+    };
+
+    HttpParser() = default;
+    explicit HttpParser(const Limits& limits) : mLimits(limits) {}
+
+    Result parse(std::string_view buffer, HttpRequest& request);
+
+    // 为下一个请求重置状态 (调用方需先从缓冲区移除已消费的字节)
+    void reset();
+
+    // 完成时该请求在缓冲区中占用的字节数
+    [[nodiscard]] size_t consumed() const { return mConsumed; }
+    // 已经开始接收请求 (用于区分空闲连接和半截请求)
+    [[nodiscard]] bool hasPartialRequest() const { return mState != State::RequestLine || mScanPos > mLineStart; }
+    // 请求头已解析完，正在等待请求体
+    [[nodiscard]] bool receivingBody() const { return mState == State::Body; }
+
+    // 出错时对应的 HTTP 状态码和说明
+    [[nodiscard]] int errorStatus() const { return mErrorStatus; }
+    [[nodiscard]] const char* errorText() const { return mErrorText; }
+
+private:
+    enum class State { RequestLine, Headers, Body, Done, Failed };
+
+    struct Span {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+    struct HeaderSpan {
+        Span name;
+        Span value;
+    };
+
+    Result fail(int status, const char* text);
+    bool parseRequestLine(std::string_view buffer, size_t begin, size_t end);
+    bool parseHeaderLine(std::string_view buffer, size_t begin, size_t end);
+
+    Limits mLimits;
+    State mState = State::RequestLine;
+    size_t mScanPos = 0;   // 下一次查找换行符的位置
+    size_t mLineStart = 0; // 当前行的起始位置
+    size_t mBodyStart = 0;
+    size_t mContentLength = 0;
+    size_t mConsumed = 0;
+
+    Span mMethod, mTarget, mVersion;
+    std::vector<HeaderSpan> mHeaders;
+
+    int mErrorStatus = 0;
+    const char* mErrorText = "";
+};
+
+} // namespace serverinfo_rest
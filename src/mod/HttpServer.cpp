@@ -1,14 +1,86 @@
 #include "mod/HttpServer.h"
+#include "mod/Log.h"
 #include "mod/ServerInfoRestMod.h"
+#include "mod/Poller.h"
+#include "mod/ThreadPool.h"
 
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <chrono>
 
 namespace serverinfo_rest {
 
+static bool statusAllowsBody(int statusCode) {
+    return statusCode >= 200 && statusCode != 204 && statusCode != 304;
+}
+
+// 文本类响应和由 JSON 转换来的二进制响应 (键名重复度高) 才值得压缩
+static bool isCompressibleType(std::string_view contentType) {
+    return contentType.starts_with("application/json") || contentType.starts_with("text/") ||
+           contentType.starts_with("application/javascript") || contentType == "application/msgpack" ||
+           contentType == "application/cbor";
+}
+
+// 在 Vary 头中追加一个请求头名
+static void addVary(HttpResponse& response, std::string_view header) {
+    auto& vary = response.headers["Vary"];
+    if (!vary.empty()) vary += ", ";
+    vary += header;
+}
+
+// 在 ETag 结尾的引号前插入后缀，例如 "abc" -> "abc-msgpack"
+static void insertETagSuffix(std::string& etag, std::string_view suffix) {
+    if (!suffix.empty() && etag.size() >= 2 && etag.back() == '"') {
+        etag.insert(etag.size() - 1, suffix);
+    }
+}
+
+// 去掉 ETag 结尾的编码后缀，有后缀时返回 true
+static bool removeEncodingTag(std::string& etag) {
+    for (auto encoding : {ContentEncoding::Gzip, ContentEncoding::Deflate, ContentEncoding::Brotli}) {
+        std::string_view suffix = contentEncodingTag(encoding);
+        if (etag.size() >= suffix.size() + 2 && etag.back() == '"' &&
+            std::string_view(etag).substr(etag.size() - 1 - suffix.size(), suffix.size()) == suffix) {
+            etag.erase(etag.size() - 1 - suffix.size(), suffix.size());
+            return true;
+        }
+    }
+    return false;
+}
+
+// 单独统计的状态码，其余的归入 "other"
+static constexpr int kCountedStatuses[] = {101, 200, 204, 304, 400, 401, 403, 404, 405,
+                                           408, 413, 426, 429, 431, 500, 501, 503, 504};
+static constexpr size_t kStatusSlots = std::size(kCountedStatuses) + 1;
+
+static size_t statusSlot(int statusCode) {
+    for (size_t i = 0; i < std::size(kCountedStatuses); ++i) {
+        if (kCountedStatuses[i] == statusCode) return i;
+    }
+    return std::size(kCountedStatuses);
+}
+
+// 没有待触发的超时时事件循环的最长等待时间，同时也是心跳等周期任务的间隔 (毫秒)
+static constexpr int kPollIntervalMs = 500;
+
+// 连接超时时间轮的精度 (毫秒)，有连接时事件循环每个 tick 醒来一次
+static constexpr int kTimerTickMs = 100;
+
+// 一次可读事件最多缓冲的输入字节数：超过一个最大请求 (请求头 + 请求体) 后先停止读取，交给解析器判断；
+// 请求头过大时解析器返回 431，声明的请求体过大时返回 413，否则缓冲区中至少有一个完整请求，剩余数据留在内核中等待下一轮
+static constexpr size_t kMaxBufferedInput = HttpParser::Limits{}.maxHeaderBytes + HttpParser::Limits{}.maxBodyBytes;
+
+static uint64_t elapsedMicros(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+}
+
 HttpServer::HttpServer(const std::string& host, int port, ServerInfoRestMod* mod)
-    : mHost(host), mPort(port), mMod(mod) {}
+    : mHost(host), mPort(port), mMod(mod),
+      mTimers(std::chrono::milliseconds(kTimerTickMs), std::chrono::steady_clock::now()),
+      mEvents(std::make_unique<EventStream>(static_cast<size_t>(std::max(1, mod->getConfig().sseHistorySize)))) {}
 
 HttpServer::~HttpServer() {
     stop();
@@ -16,174 +88,1044 @@ HttpServer::~HttpServer() {
 
 bool HttpServer::start() {
     auto& logger = mMod->getSelf().getLogger();
-    logger.debug("[HTTP] Starting HTTP server...");
-    
-    // 初始化 Winsock
-    logger.trace("[HTTP] Initializing Winsock...");
-    WSADATA wsaData;
-    int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
-    if (result != 0) {
-        logger.error("[HTTP] WSAStartup failed with error: {}", result);
+    LOG_DEBUG(logger, "[HTTP] Starting HTTP server...");
+    
+    // 初始化网络库 (Windows 下为 Winsock)
+    LOG_TRACE(logger, "[HTTP] Initializing network stack...");
+    int result = 0;
+    if (!net::startup(result)) {
+        LOG_ERROR(logger, "[HTTP] Network startup (WSAStartup) failed with error: {}", result);
         return false;
     }
-    logger.debug("[HTTP] WSAStartup succeeded (version: {}.{})", 
-                 LOBYTE(wsaData.wVersion), HIBYTE(wsaData.wVersion));
+    LOG_DEBUG(logger, "[HTTP] Network stack initialized");
 
     // 创建 socket
-    logger.trace("[HTTP] Creating server socket...");
+    LOG_TRACE(logger, "[HTTP] Creating server socket...");
     mServerSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (mServerSocket == INVALID_SOCKET) {
-        logger.error("[HTTP] Socket creation failed with error: {}", WSAGetLastError());
-        WSACleanup();
+    if (mServerSocket == net::kInvalidSocket) {
+        LOG_ERROR(logger, "[HTTP] Socket creation failed with error: {}", net::lastError());
+        net::cleanup();
         return false;
     }
-    logger.debug("[HTTP] Server socket created successfully");
+    LOG_DEBUG(logger, "[HTTP] Server socket created successfully");
 
     // 设置 SO_REUSEADDR
     int opt = 1;
     setsockopt(mServerSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
-    logger.trace("[HTTP] SO_REUSEADDR option set");
+    LOG_TRACE(logger, "[HTTP] SO_REUSEADDR option set");
 
     // 绑定地址
-    logger.trace("[HTTP] Binding to {}:{}...", mHost, mPort);
+    LOG_TRACE(logger, "[HTTP] Binding to {}:{}...", mHost, mPort);
     sockaddr_in serverAddr{};
     serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(static_cast<u_short>(mPort));
+    serverAddr.sin_port = htons(static_cast<uint16_t>(mPort));
     
     if (mHost == "0.0.0.0") {
         serverAddr.sin_addr.s_addr = INADDR_ANY;
-        logger.trace("[HTTP] Binding to all interfaces (INADDR_ANY)");
+        LOG_TRACE(logger, "[HTTP] Binding to all interfaces (INADDR_ANY)");
     } else {
         inet_pton(AF_INET, mHost.c_str(), &serverAddr.sin_addr);
-        logger.trace("[HTTP] Binding to specific interface: {}", mHost);
+        LOG_TRACE(logger, "[HTTP] Binding to specific interface: {}", mHost);
     }
 
-    if (bind(mServerSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-        logger.error("[HTTP] Bind failed with error: {}", WSAGetLastError());
-        closesocket(mServerSocket);
-        WSACleanup();
+    if (bind(mServerSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) != 0) {
+        LOG_ERROR(logger, "[HTTP] Bind failed with error: {}", net::lastError());
+        net::closeSocket(mServerSocket);
+        mServerSocket = net::kInvalidSocket;
+        net::cleanup();
         return false;
     }
-    logger.debug("[HTTP] Socket bound to {}:{}", mHost, mPort);
+    LOG_DEBUG(logger, "[HTTP] Socket bound to {}:{}", mHost, mPort);
 
     // 开始监听
-    logger.trace("[HTTP] Starting to listen (backlog: SOMAXCONN)...");
-    if (listen(mServerSocket, SOMAXCONN) == SOCKET_ERROR) {
-        logger.error("[HTTP] Listen failed with error: {}", WSAGetLastError());
-        closesocket(mServerSocket);
-        WSACleanup();
+    // backlog 是内核中已完成握手、等待 accept 的连接队列长度，队列满时新连接会被内核拒绝或重试
+    int backlog = mMod->getConfig().acceptBacklog > 0 ? mMod->getConfig().acceptBacklog : SOMAXCONN;
+    LOG_TRACE(logger, "[HTTP] Starting to listen (backlog: {})...", backlog);
+    if (listen(mServerSocket, backlog) != 0 || !net::setNonBlocking(mServerSocket)) {
+        LOG_ERROR(logger, "[HTTP] Listen failed with error: {}", net::lastError());
+        net::closeSocket(mServerSocket);
+        mServerSocket = net::kInvalidSocket;
+        net::cleanup();
+        return false;
+    }
+    LOG_DEBUG(logger, "[HTTP] Socket is now listening");
+
+    // 创建事件多路复用器
+    mPoller = std::make_unique<net::Poller>();
+    if (!mPoller->isValid() || !mPoller->add(mServerSocket, net::PollReadable)) {
+        LOG_ERROR(logger, "[HTTP] Failed to initialize {} poller: {}", mPoller->backendName(), net::lastError());
+        mPoller.reset();
+        net::closeSocket(mServerSocket);
+        mServerSocket = net::kInvalidSocket;
+        net::cleanup();
         return false;
     }
-    logger.debug("[HTTP] Socket is now listening");
+    LOG_DEBUG(logger, "[HTTP] Event loop backend: {}", mPoller->backendName());
 
-    // 启动服务器线程
-    logger.trace("[HTTP] Starting server thread...");
+    // 冻结路由表，此后工作线程可以无锁查找
+    mRouter.freeze();
+    LOG_DEBUG(logger, "[HTTP] Route table frozen ({} routes)", mRouter.routes().size());
+    
+    // 路由表已固定，按路由数分配请求计数器
+    mRequestCountSlots = (mRouter.routes().size() + 1) * kStatusSlots;
+    mRequestCounts = std::make_unique<std::atomic<uint64_t>[]>(mRequestCountSlots);
+    if (mMod->getConfig().enableDebugStats) {
+        mLatency = std::make_unique<LatencyStats>(mRouter.routes().size() + 1);
+        LOG_DEBUG(logger, "[HTTP] Latency statistics enabled");
+    }
+
+    // 启动工作线程池
+    const auto& config = mMod->getConfig();
+    if (config.enableRateLimit) {
+        mRateLimiter = std::make_unique<RateLimiter>(static_cast<size_t>(std::max(1, config.rateLimitMaxClients)),
+                                                     std::chrono::milliseconds(config.rateLimitIdleTimeout));
+        LOG_DEBUG(logger, "[HTTP] Rate limiting enabled ({}/s per IP, {}/s per token)", config.rateLimitPerIp,
+                  config.rateLimitPerToken);
+    }
+    std::size_t workerThreads = config.workerThreads > 0 ? static_cast<std::size_t>(config.workerThreads)
+                                                         : std::max(1u, std::thread::hardware_concurrency());
+    std::size_t workerQueueSize = static_cast<std::size_t>(std::max(1, config.workerQueueSize));
+    mWorkerPool = std::make_unique<ThreadPool>(workerThreads, workerQueueSize);
+    LOG_DEBUG(logger, "[HTTP] Worker pool started ({} threads, queue size: {})", workerThreads, workerQueueSize);
+
+    // 启动事件循环线程
+    LOG_TRACE(logger, "[HTTP] Starting event loop thread...");
     mRunning = true;
-    mServerThread = std::thread(&HttpServer::serverLoop, this);
+    mServerThread = std::thread(&HttpServer::eventLoop, this);
     
-    logger.info("[HTTP] HTTP server started on http://{}:{}", mHost, mPort);
+    LOG_INFO(logger, "[HTTP] HTTP server started on http://{}:{}", mHost, mPort);
     return true;
 }
 
 void HttpServer::stop() {
     if (!mRunning) {
-        mMod->getSelf().getLogger().trace("[HTTP] stop() called but server not running");
+        LOG_TRACE(mMod->getSelf().getLogger(), "[HTTP] stop() called but server not running");
         return;
     }
     
     auto& logger = mMod->getSelf().getLogger();
-    logger.info("[HTTP] Stopping HTTP server...");
+    LOG_INFO(logger, "[HTTP] Stopping HTTP server...");
     
     mRunning = false;
-    logger.debug("[HTTP] Running flag set to false");
+    LOG_DEBUG(logger, "[HTTP] Running flag set to false");
     
-    // 关闭服务器 socket 以中断 accept
-    if (mServerSocket != INVALID_SOCKET) {
-        logger.debug("[HTTP] Closing server socket...");
-        closesocket(mServerSocket);
-        mServerSocket = INVALID_SOCKET;
-        logger.debug("[HTTP] Server socket closed");
+    // 唤醒事件循环，由它关闭所有客户端连接后退出
+    if (mPoller) {
+        mPoller->wakeup();
     }
-    
-    // 等待服务器线程结束
     if (mServerThread.joinable()) {
-        logger.debug("[HTTP] Waiting for server thread to finish...");
+        LOG_DEBUG(logger, "[HTTP] Waiting for event loop thread to finish...");
         mServerThread.join();
-        logger.debug("[HTTP] Server thread joined");
+        LOG_DEBUG(logger, "[HTTP] Event loop thread joined");
+    }
+    
+    // 等待工作线程处理完手上的请求 (结果会被丢弃)
+    if (mWorkerPool) {
+        LOG_DEBUG(logger, "[HTTP] Shutting down worker pool...");
+        mWorkerPool->shutdown();
+        mWorkerPool.reset();
+        LOG_DEBUG(logger, "[HTTP] Worker pool stopped");
     }
+    mCompletions.clear();
+    mPoller.reset();
     
-    WSACleanup();
-    logger.debug("[HTTP] WSACleanup completed");
-    logger.info("[HTTP] HTTP server stopped");
+    if (mServerSocket != net::kInvalidSocket) {
+        LOG_DEBUG(logger, "[HTTP] Closing server socket...");
+        net::closeSocket(mServerSocket);
+        mServerSocket = net::kInvalidSocket;
+        LOG_DEBUG(logger, "[HTTP] Server socket closed");
+    }
+    
+    net::cleanup();
+    LOG_DEBUG(logger, "[HTTP] Network stack cleaned up");
+    LOG_INFO(logger, "[HTTP] HTTP server stopped");
 }
 
-void HttpServer::serverLoop() {
+// ==================== 事件循环 ====================
+
+void HttpServer::eventLoop() {
     auto& logger = mMod->getSelf().getLogger();
-    logger.debug("[HTTP] Server loop started, waiting for connections...");
+    LOG_DEBUG(logger, "[HTTP] Event loop started, waiting for connections...");
+    
+    std::vector<net::PollResult> events;
+    mLastIdleScan = std::chrono::steady_clock::now();
     
-    int connectionCount = 0;
     while (mRunning) {
-        sockaddr_in clientAddr{};
-        int clientAddrLen = sizeof(clientAddr);
+        int count = mPoller->wait(events, mTimers.size() > 0 ? kTimerTickMs : kPollIntervalMs);
+        if (count < 0) {
+            LOG_WARN(logger, "[HTTP] Poll failed with error: {}", net::lastError());
+            continue;
+        }
         
-        SOCKET clientSocket = accept(mServerSocket, (sockaddr*)&clientAddr, &clientAddrLen);
+        for (const auto& event : events) {
+            if (event.socket == mServerSocket) {
+                acceptConnections();
+                continue;
+            }
+            
+            auto it = mConnections.find(event.socket);
+            if (it == mConnections.end()) {
+                continue;
+            }
+            HttpConnection& conn = *it->second;
+            
+            if (event.events & net::PollWritable) {
+                onWritable(conn);
+                if (!mConnections.count(event.socket)) continue;
+            }
+            if (event.events & (net::PollReadable | net::PollError)) {
+                // 出错时同样走读取路径，由 recv 的返回值决定是否关闭
+                onReadable(conn);
+            }
+        }
         
-        if (clientSocket == INVALID_SOCKET) {
-            if (mRunning) {
-                int error = WSAGetLastError();
-                if (error != WSAEINTR && error != WSAENOTSOCK) {
-                    logger.debug("[HTTP] Accept failed with error: {}", error);
+        drainCompletions();
+        fanoutEvents();
+        if (mWebSocketsDirty.exchange(false)) {
+            // 推送过程中可能关闭连接，先复制一份列表
+            std::vector<net::Socket> sockets(mWebSockets.begin(), mWebSockets.end());
+            for (auto socket : sockets) {
+                auto it = mConnections.find(socket);
+                if (it != mConnections.end()) {
+                    pollWebSocket(*it->second);
                 }
             }
+        }
+        expireIdleConnections();
+    }
+    
+    // 关闭所有剩余连接
+    LOG_DEBUG(logger, "[HTTP] Closing {} open connections...", mConnections.size());
+    for (auto& [socket, conn] : mConnections) {
+        mPoller->remove(socket);
+        net::closeSocket(socket);
+    }
+    mConnections.clear();
+    mOpenConnections.store(0, std::memory_order_relaxed);
+    mEventSubscribers.clear();
+    mWebSockets.clear();
+    
+    LOG_DEBUG(logger, "[HTTP] Event loop ended, total connections handled: {}", mTotalConnections);
+}
+
+void HttpServer::acceptConnections() {
+    auto& logger = mMod->getSelf().getLogger();
+    size_t maxConnections = static_cast<size_t>(std::max(0, mMod->getConfig().maxConnections));
+    
+    // 水平触发：一次性取完 backlog 中的所有连接
+    while (mRunning) {
+        sockaddr_in clientAddr{};
+        net::SockLen clientAddrLen = sizeof(clientAddr);
+        
+        net::Socket clientSocket = accept(mServerSocket, (sockaddr*)&clientAddr, &clientAddrLen);
+        if (clientSocket == net::kInvalidSocket) {
+            int error = net::lastError();
+            if (!net::isWouldBlock(error) && !net::isInterrupted(error)) {
+                LOG_DEBUG(logger, "[HTTP] Accept failed with error: {}", error);
+            }
+            return;
+        }
+        
+        // 连接数已达上限：不注册到事件循环，返回 503 后立即关闭
+        if (maxConnections > 0 && mConnections.size() >= maxConnections) {
+            shedConnection(clientSocket);
             continue;
         }
         
-        connectionCount++;
+        if (!net::setNonBlocking(clientSocket) || !mPoller->add(clientSocket, net::PollReadable)) {
+            LOG_WARN(logger, "[HTTP] Failed to register client socket: {}", net::lastError());
+            net::closeSocket(clientSocket);
+            continue;
+        }
+        net::setNoDelay(clientSocket);
         
         // 获取客户端 IP 和端口
         char clientIP[INET_ADDRSTRLEN];
         inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
         int clientPort = ntohs(clientAddr.sin_port);
         
-        logger.trace("[HTTP] Connection #{} from {}:{}", connectionCount, clientIP, clientPort);
+        auto conn = std::make_unique<HttpConnection>();
+        conn->socket = clientSocket;
+        conn->id = mNextConnectionId++;
+        conn->remoteAddr = std::string(clientIP) + ":" + std::to_string(clientPort);
+        conn->lastActive = std::chrono::steady_clock::now();
+        conn->deadlineTimer.tag = static_cast<uint64_t>(clientSocket);
+        setDeadline(*conn, ConnectionDeadline::Header);
+        mTotalConnections++;
         
-        // 处理客户端请求（同步处理，简单起见）
-        handleClient(clientSocket);
+        LOG_TRACE(logger, "[HTTP] Connection #{} from {} ({} open)", conn->id, conn->remoteAddr,
+                  mConnections.size() + 1);
+        mConnections[clientSocket] = std::move(conn);
+        mOpenConnections.store(mConnections.size(), std::memory_order_relaxed);
+    }
+}
+
+// 拒绝超出上限的连接：尽力发送一次 503 (不等待发送缓冲区)，然后关闭
+void HttpServer::shedConnection(net::Socket socket) {
+    auto& logger = mMod->getSelf().getLogger();
+    uint64_t shed = mShedConnections.fetch_add(1, std::memory_order_relaxed) + 1;
+    // 过载时可能每秒触发很多次，只在第一次和之后每 1000 次记录警告
+    if (shed == 1 || shed % 1000 == 0) {
+        LOG_WARN(logger, "[HTTP] Connection limit reached ({} open), {} connections shed so far",
+                 mConnections.size(), shed);
     }
     
-    logger.debug("[HTTP] Server loop ended, total connections handled: {}", connectionCount);
+    HttpResponse response;
+    response.setStatus(503, "Service Unavailable");
+    response.headers["Retry-After"] = "1";
+    response.setJson("{\"error\": \"Too many connections\"}");
+    std::string data = buildResponse(response);
+    if (net::setNonBlocking(socket)) {
+        net::sendBytes(socket, data.data(), data.size());
+    }
+    net::closeSocket(socket);
 }
 
-void HttpServer::handleClient(SOCKET clientSocket) {
+void HttpServer::onReadable(HttpConnection& conn) {
     auto& logger = mMod->getSelf().getLogger();
     
-    // 设置超时
-    DWORD timeout = 5000; // 5 seconds
-    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-    logger.trace("[HTTP] Client socket timeout set to {}ms", timeout);
+    // 处理中的连接不关注可读事件，走到这里说明连接出错或被挂断
+    if (conn.busy) {
+        LOG_TRACE(logger, "[HTTP] Connection #{} hung up while request in flight", conn.id);
+        closeConnection(conn.socket);
+        return;
+    }
     
-    // 读取请求
     char buffer[8192];
-    std::string rawRequest;
+    while (true) {
+        int bytesReceived = net::recvBytes(conn.socket, buffer, sizeof(buffer));
+        if (bytesReceived > 0) {
+            if (conn.inBuffer->empty()) {
+                conn.requestStart = std::chrono::steady_clock::now();
+            }
+            conn.inBuffer->append(buffer, static_cast<size_t>(bytesReceived));
+            conn.lastActive = std::chrono::steady_clock::now();
+            LOG_TRACE(logger, "[HTTP] Received {} bytes from {}", bytesReceived, conn.remoteAddr);
+            if (conn.inBuffer->size() > kMaxBufferedInput) {
+                break;
+            }
+            continue;
+        }
+        if (bytesReceived == 0) {
+            LOG_TRACE(logger, "[HTTP] Connection #{} closed by client after {} requests", conn.id, conn.requestsServed);
+            closeConnection(conn.socket);
+            return;
+        }
+        int error = net::lastError();
+        if (net::isWouldBlock(error)) {
+            break;
+        }
+        if (!net::isInterrupted(error)) {
+            LOG_TRACE(logger, "[HTTP] Connection #{} recv error: {}", conn.id, error);
+            closeConnection(conn.socket);
+            return;
+        }
+    }
+    
+    dispatchRequest(conn);
+}
+
+void HttpServer::dispatchRequest(HttpConnection& conn) {
+    auto& logger = mMod->getSelf().getLogger();
+    
+    if (conn.webSocket) {
+        readWebSocket(conn);
+        return;
+    }
+    
+    // SSE 连接只用于推送，客户端发来的数据直接丢弃
+    if (conn.eventStream) {
+        conn.inBuffer->clear();
+        return;
+    }
+    
+    // 同一连接同一时间只处理一个请求，保证流水线响应的顺序
+    if (conn.busy || conn.closeAfterWrite || conn.outOffset < conn.outBuffer.size()) {
+        return;
+    }
+    
+    // 限流在解析之前进行：请求行到齐后按 IP 和 token 各扣一个令牌，超限的请求不再解析
+    if (mRateLimiter && !conn.rateChecked) {
+        std::string_view buffered = *conn.inBuffer;
+        size_t lineEnd = buffered.find('\n');
+        if (lineEnd != std::string_view::npos) {
+            std::chrono::milliseconds retryAfter{0};
+            if (!checkRateLimit(conn, buffered.substr(0, lineEnd), retryAfter)) {
+                LOG_DEBUG(logger, "[HTTP] Rate limit exceeded for {}, retry after {}ms", conn.remoteAddr,
+                          retryAfter.count());
+                HttpResponse response;
+                response.setStatus(429, "Too Many Requests");
+                auto retrySeconds = std::max<int64_t>(1, (retryAfter.count() + 999) / 1000);
+                response.headers["Retry-After"] = std::to_string(retrySeconds);
+                response.setJson("{\"error\": \"Rate limit exceeded\"}");
+                rejectRequest(conn, response);
+                return;
+            }
+            conn.rateChecked = true;
+        }
+    }
+    
+    // 从上次停下的位置继续解析
+    LatencyStats* latency = mLatency.get();
+    std::chrono::steady_clock::time_point parseStart;
+    if (latency) parseStart = std::chrono::steady_clock::now();
+    
+    HttpRequest request;
+    auto result = conn.parser.parse(*conn.inBuffer, request);
+    if (result == HttpParser::Result::Incomplete) {
+        // 请求头和请求体分别计时，从开始接收时算起
+        if (conn.inBuffer->empty()) {
+            setDeadline(conn, ConnectionDeadline::Idle);
+        } else {
+            setDeadline(conn, conn.parser.receivingBody() ? ConnectionDeadline::Body : ConnectionDeadline::Header);
+        }
+        return;
+    }
+    std::chrono::steady_clock::time_point dispatchedAt;
+    if (latency) {
+        dispatchedAt = std::chrono::steady_clock::now();
+        latency->record(LatencyPhase::Parse, elapsedMicros(parseStart, dispatchedAt));
+        latency->record(LatencyPhase::Receive, elapsedMicros(conn.requestStart, dispatchedAt));
+    }
+    if (result == HttpParser::Result::Error) {
+        LOG_DEBUG(logger, "[HTTP] Rejecting malformed request from {}: {} {}", conn.remoteAddr,
+                  conn.parser.errorStatus(), conn.parser.errorText());
+        HttpResponse response;
+        response.setStatus(conn.parser.errorStatus(), conn.parser.errorText());
+        response.setJson("{\"error\": \"" + std::string(conn.parser.errorText()) + "\"}");
+        rejectRequest(conn, response);
+        return;
+    }
+    
+    conn.requestsServed++;
+    conn.busy = true;
+    clearDeadline(conn);
+    
+    // 高优先级路由直接在事件循环中处理，不排在慢请求后面；
+    // 流水线中的后续请求会在 completeRequest 中再次进入这里，为避免递归只直接处理最外层的一个
+    auto match = mRouter.match(parseHttpMethod(request.method), request.path, request.pathParams);
+    if (match.route && match.route->priority == RoutePriority::High && !mInlineRequest) {
+        mInlineRequest = true;
+        HttpCompletion completion{conn.socket, conn.id, {}, false};
+        completion.data = processRequest(request, conn.requestsServed, completion);
+        if (latency) {
+            completion.completedAt = std::chrono::steady_clock::now();
+        }
+        completeRequest(completion);
+        mInlineRequest = false;
+        return;
+    }
+    updateInterest(conn);
+    
+    net::Socket socket = conn.socket;
+    uint64_t connectionId = conn.id;
+    int requestsServed = conn.requestsServed;
+    bool submitted = mWorkerPool->trySubmit([this, socket, connectionId, requestsServed, dispatchedAt,
+                                             buffer = conn.inBuffer, request = std::move(request)]() mutable {
+        if (mLatency) {
+            mLatency->record(LatencyPhase::Queue, elapsedMicros(dispatchedAt, std::chrono::steady_clock::now()));
+        }
+        HttpCompletion completion{socket, connectionId, {}, false};
+        completion.data = processRequest(request, requestsServed, completion);
+        if (mLatency) {
+            completion.completedAt = std::chrono::steady_clock::now();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mCompletionMutex);
+            mCompletions.push_back(std::move(completion));
+        }
+        mPoller->wakeup();
+    });
+    
+    if (!submitted) {
+        // 工作队列已满，直接在事件循环中返回 503
+        LOG_WARN(logger, "[HTTP] Worker queue full ({} pending), rejecting request from {}",
+                 mWorkerPool->pendingCount(), conn.remoteAddr);
+        HttpResponse response;
+        response.setStatus(503, "Service Unavailable");
+        response.headers["Retry-After"] = "1";
+        response.setJson("{\"error\": \"Server busy\"}");
+        conn.busy = false;
+        rejectRequest(conn, response);
+    }
+}
+
+// 在事件循环中直接返回错误响应，发送完毕后关闭连接
+void HttpServer::rejectRequest(HttpConnection& conn, HttpResponse& response) {
+    countRequest(mRouter.routes().size(), response.statusCode);
+    conn.closeAfterWrite = true;
+    conn.outBuffer = buildResponse(response);
+    conn.outOffset = 0;
+    if (flushOutput(conn)) {
+        finishWrite(conn);
+    }
+}
+
+void HttpServer::drainCompletions() {
+    std::vector<HttpCompletion> completions;
+    {
+        std::lock_guard<std::mutex> lock(mCompletionMutex);
+        completions.swap(mCompletions);
+    }
+    
+    for (auto& completion : completions) {
+        completeRequest(completion);
+    }
+}
+
+// 把处理结果交给连接并开始发送 (运行在事件循环线程)
+void HttpServer::completeRequest(HttpCompletion& completion) {
+    auto it = mConnections.find(completion.socket);
+    // 连接可能已在处理期间关闭 (socket 句柄也可能已被复用)
+    if (it == mConnections.end() || it->second->id != completion.connectionId) {
+        return;
+    }
+    HttpConnection& conn = *it->second;
+    conn.busy = false;
+    conn.closeAfterWrite = !completion.keepAlive;
+    
+    // 工作线程已不再引用缓冲区，移除已处理的请求，剩下的是下一个流水线请求
+    conn.inBuffer->erase(0, conn.parser.consumed());
+    conn.parser.reset();
+    conn.rateChecked = false;
+    if (!conn.inBuffer->empty()) {
+        conn.requestStart = std::chrono::steady_clock::now();
+    }
+    conn.outBuffer = std::move(completion.data);
+    conn.outOffset = 0;
+    conn.lastActive = std::chrono::steady_clock::now();
+    if (mLatency) {
+        mLatency->record(LatencyPhase::Wakeup, elapsedMicros(completion.completedAt, conn.lastActive));
+        conn.responseReady = conn.lastActive;
+        conn.routeSlot = completion.routeSlot;
+    }
+    
+    if (completion.eventStream) {
+        openEventStream(conn, completion);
+    } else if (completion.webSocket) {
+        openWebSocket(conn, std::move(completion.webSocket));
+    }
+    if (flushOutput(conn)) {
+        finishWrite(conn);
+    }
+}
+
+void HttpServer::onWritable(HttpConnection& conn) {
+    if (flushOutput(conn)) {
+        finishWrite(conn);
+    }
+}
+
+// 尽可能多地发送 outBuffer，全部发送完毕返回 true；连接被关闭或仍有剩余返回 false
+bool HttpServer::flushOutput(HttpConnection& conn) {
+    auto& logger = mMod->getSelf().getLogger();
+    
+    while (conn.outOffset < conn.outBuffer.size()) {
+        int bytesSent = net::sendBytes(conn.socket, conn.outBuffer.data() + conn.outOffset,
+                                       conn.outBuffer.size() - conn.outOffset);
+        if (bytesSent > 0) {
+            conn.outOffset += static_cast<size_t>(bytesSent);
+            continue;
+        }
+        int error = net::lastError();
+        if (net::isWouldBlock(error)) {
+            // SSE / WebSocket 由积压上限和心跳处理慢客户端
+            if (!conn.eventStream && !conn.webSocket) {
+                setDeadline(conn, ConnectionDeadline::Write);
+            }
+            updateInterest(conn);
+            return false;
+        }
+        if (net::isInterrupted(error)) {
+            continue;
+        }
+        LOG_WARN(logger, "[HTTP] Failed to send response: {}", error);
+        closeConnection(conn.socket);
+        return false;
+    }
+    
+    LOG_TRACE(logger, "[HTTP] Sent {} bytes to {}", conn.outBuffer.size(), conn.remoteAddr);
+    return true;
+}
+
+// 响应发送完毕后：关闭连接，或继续处理缓冲区中的下一个流水线请求
+void HttpServer::finishWrite(HttpConnection& conn) {
+    conn.outBuffer.clear();
+    conn.outOffset = 0;
+    conn.lastActive = std::chrono::steady_clock::now();
+    
+    if (mLatency && conn.routeSlot != SIZE_MAX) {
+        uint64_t total = elapsedMicros(conn.requestStart, conn.lastActive);
+        mLatency->record(LatencyPhase::Send, elapsedMicros(conn.responseReady, conn.lastActive));
+        mLatency->record(LatencyPhase::Total, total);
+        mLatency->recordRouteTotal(conn.routeSlot, total);
+        conn.routeSlot = SIZE_MAX;
+    }
+    
+    if (conn.eventStream) {
+        conn.lastWrite = conn.lastActive;
+        pumpEvents(conn);
+        return;
+    }
+    if (conn.webSocket && !conn.closeAfterWrite) {
+        updateInterest(conn);
+        // 握手发送前就收到的帧，或因缓冲区超限而推迟的推送
+        if (!conn.inBuffer->empty()) {
+            readWebSocket(conn);
+        } else if (conn.wsPollPending) {
+            pollWebSocket(conn);
+        }
+        return;
+    }
+    if (conn.closeAfterWrite) {
+        closeConnection(conn.socket);
+        return;
+    }
+    updateInterest(conn);
+    dispatchRequest(conn);
+}
+
+void HttpServer::updateInterest(HttpConnection& conn) {
+    uint32_t interest = net::PollNone;
+    if (conn.eventStream || conn.webSocket) {
+        // SSE / WebSocket 连接始终关注可读事件，以便及时发现客户端断开和接收控制帧
+        interest = net::PollReadable;
+        if (conn.outOffset < conn.outBuffer.size()) {
+            interest |= net::PollWritable;
+        }
+    } else if (conn.outOffset < conn.outBuffer.size()) {
+        interest = net::PollWritable;
+    } else if (!conn.busy) {
+        interest = net::PollReadable;
+    }
+    mPoller->modify(conn.socket, interest);
+}
+
+void HttpServer::expireIdleConnections() {
+    auto now = std::chrono::steady_clock::now();
+    expireDeadlines(now);
+    if (now - mLastIdleScan < std::chrono::milliseconds(kPollIntervalMs)) {
+        return;
+    }
+    mLastIdleScan = now;
+    sendHeartbeats(now);
+    pingWebSockets(now);
+    if (mRateLimiter) {
+        mRateLimiter->evictIdle(now);
+    }
+}
+
+// 处理到期的连接超时：只处理当前 tick 到期的连接，不扫描整个连接表
+void HttpServer::expireDeadlines(std::chrono::steady_clock::time_point now) {
+    mExpiredTimers.clear();
+    if (mTimers.advance(now, mExpiredTimers) == 0) {
+        return;
+    }
+    
+    auto& logger = mMod->getSelf().getLogger();
+    for (uint64_t tag : mExpiredTimers) {
+        auto it = mConnections.find(static_cast<net::Socket>(tag));
+        // 连接关闭时定时器随之销毁，这里找到的一定是定时器的拥有者；已重新调度的跳过
+        if (it == mConnections.end() || it->second->deadlineTimer.scheduled() || it->second->busy) {
+            continue;
+        }
+        HttpConnection& conn = *it->second;
+        ConnectionDeadline deadline = conn.deadline;
+        conn.deadline = ConnectionDeadline::None;
+        switch (deadline) {
+        case ConnectionDeadline::Header:
+        case ConnectionDeadline::Body: {
+            if (conn.inBuffer->empty()) {
+                LOG_TRACE(logger, "[HTTP] Connection #{} closed: no request received", conn.id);
+                closeConnection(conn.socket);
+                break;
+            }
+            LOG_DEBUG(logger, "[HTTP] Request {} timeout for {}",
+                      deadline == ConnectionDeadline::Header ? "header" : "body", conn.remoteAddr);
+            HttpResponse response;
+            response.setStatus(408, "Request Timeout");
+            response.setJson("{\"error\": \"Request timeout\"}");
+            rejectRequest(conn, response);
+            break;
+        }
+        case ConnectionDeadline::Idle:
+            LOG_TRACE(logger, "[HTTP] Connection #{} idle timeout", conn.id);
+            closeConnection(conn.socket);
+            break;
+        case ConnectionDeadline::Write:
+            LOG_DEBUG(logger, "[HTTP] Write timeout for {} ({} of {} bytes sent)", conn.remoteAddr, conn.outOffset,
+                      conn.outBuffer.size());
+            closeConnection(conn.socket);
+            break;
+        case ConnectionDeadline::None:
+            break;
+        }
+    }
+}
+
+// 切换连接的超时类型；类型不变时保留原来的到期时间，收到更多数据不会续期
+void HttpServer::setDeadline(HttpConnection& conn, ConnectionDeadline deadline) {
+    if (conn.deadline == deadline && conn.deadlineTimer.scheduled()) {
+        return;
+    }
+    const auto& config = mMod->getConfig();
+    int timeoutMs = 0;
+    switch (deadline) {
+    case ConnectionDeadline::Header: timeoutMs = config.headerTimeout; break;
+    case ConnectionDeadline::Body: timeoutMs = config.bodyTimeout; break;
+    case ConnectionDeadline::Idle: timeoutMs = std::max(1, config.keepAliveTimeout); break;
+    case ConnectionDeadline::Write: timeoutMs = config.writeTimeout; break;
+    case ConnectionDeadline::None: break;
+    }
+    conn.deadline = deadline;
+    if (timeoutMs <= 0) {
+        conn.deadlineTimer.cancel();
+        return;
+    }
+    mTimers.schedule(conn.deadlineTimer, std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs));
+}
+
+void HttpServer::clearDeadline(HttpConnection& conn) {
+    conn.deadline = ConnectionDeadline::None;
+    conn.deadlineTimer.cancel();
+}
+
+void HttpServer::closeConnection(net::Socket socket) {
+    auto it = mConnections.find(socket);
+    if (it == mConnections.end()) {
+        return;
+    }
+    LOG_TRACE(mMod->getSelf().getLogger(), "[HTTP] Client connection #{} closed ({} requests served)", it->second->id,
+              it->second->requestsServed);
+    mPoller->remove(socket);
+    net::closeSocket(socket);
+    mEventSubscribers.erase(socket);
+    mWebSockets.erase(socket);
+    mConnections.erase(it);
+    mOpenConnections.store(mConnections.size(), std::memory_order_relaxed);
+}
+
+// ==================== Server-Sent Events ====================
+
+// 事件缓冲区溢出导致订阅者漏掉事件时发送，提示客户端重新拉取完整状态
+static const EventFrame& resyncFrame() {
+    static const EventFrame frame = std::make_shared<const std::string>("event: resync\ndata: {}\n\n");
+    return frame;
+}
+
+void HttpServer::publishEvent(std::string_view type, std::string_view data) {
+    uint64_t id = mEvents->publish(type, data);
+    LOG_TRACE(mMod->getSelf().getLogger(), "[HTTP] Published event #{} ({})", id, type);
+    
+    // 只唤醒事件循环，真正的扇出在事件循环线程进行
+    if (mRunning && mPoller) {
+        mPoller->wakeup();
+    }
+}
+
+void HttpServer::openEventStream(HttpConnection& conn, const HttpCompletion& completion) {
+    auto& logger = mMod->getSelf().getLogger();
     
-    int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    logger.trace("[HTTP] Received {} bytes from client", bytesReceived);
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        rawRequest = buffer;
+    conn.eventStream = true;
+    conn.closeAfterWrite = false;
+    conn.lastWrite = std::chrono::steady_clock::now();
+    mEventSubscribers.insert(conn.socket);
+    
+    if (!completion.resume) {
+        // 新订阅者只接收之后发布的事件
+        conn.eventCursor = mEvents->lastId();
+        LOG_DEBUG(logger, "[HTTP] Connection #{} subscribed to events ({} subscribers)", conn.id,
+                  mEventSubscribers.size());
+        return;
+    }
+    
+    // 断线续传：从环形缓冲区补发 Last-Event-ID 之后的事件
+    std::vector<StreamEvent> missed;
+    bool complete = mEvents->collectSince(completion.lastEventId, missed);
+    if (!complete) {
+        conn.eventQueue.push_back(resyncFrame());
+    }
+    for (auto& event : missed) {
+        conn.eventQueue.push_back(std::move(event.frame));
+    }
+    conn.eventCursor = missed.empty() ? std::max(completion.lastEventId, mEvents->lastId()) : missed.back().id;
+    LOG_DEBUG(logger, "[HTTP] Connection #{} resumed events after #{} ({} replayed{})", conn.id, completion.lastEventId,
+              missed.size(), complete ? "" : ", resync required");
+}
+
+// 把新事件分发到每个订阅者的发送队列，每轮事件循环只从缓冲区取一次
+void HttpServer::fanoutEvents() {
+    uint64_t lastId = mEvents->lastId();
+    if (lastId == mLastFanoutId) {
+        return;
     }
     
-    if (rawRequest.empty()) {
-        logger.trace("[HTTP] Empty request, closing connection");
-        closesocket(clientSocket);
+    std::vector<StreamEvent> events;
+    bool complete = true;
+    if (!mEventSubscribers.empty()) {
+        complete = mEvents->collectSince(mLastFanoutId, events);
+    }
+    mLastFanoutId = lastId;
+    if (events.empty()) {
         return;
     }
     
-    logger.trace("[HTTP] Raw request (first 300 chars):\n{}", rawRequest.substr(0, 300));
+    auto& logger = mMod->getSelf().getLogger();
+    size_t maxQueued = static_cast<size_t>(std::max(1, mMod->getConfig().sseMaxQueuedEvents));
+    
+    // 推送过程中可能关闭连接，先复制一份订阅者列表
+    std::vector<net::Socket> subscribers(mEventSubscribers.begin(), mEventSubscribers.end());
+    for (auto socket : subscribers) {
+        auto it = mConnections.find(socket);
+        if (it == mConnections.end()) {
+            continue;
+        }
+        HttpConnection& conn = *it->second;
+        if (!complete && conn.eventCursor < events.front().id - 1) {
+            conn.eventQueue.push_back(resyncFrame());
+        }
+        for (const auto& event : events) {
+            if (event.id > conn.eventCursor) {
+                conn.eventQueue.push_back(event.frame);
+                conn.eventCursor = event.id;
+            }
+        }
+        
+        // 慢消费者：积压超过上限就断开，客户端可凭 Last-Event-ID 重连续传
+        if (conn.eventQueue.size() > maxQueued) {
+            LOG_DEBUG(logger, "[HTTP] Dropping slow event subscriber #{} ({} events queued)", conn.id,
+                      conn.eventQueue.size());
+            closeConnection(socket);
+            continue;
+        }
+        pumpEvents(conn);
+    }
+}
+
+// 上一批数据发送完毕后，把队列中的事件合并成一次写入
+void HttpServer::pumpEvents(HttpConnection& conn) {
+    while (conn.outOffset >= conn.outBuffer.size() && !conn.eventQueue.empty()) {
+        conn.outBuffer.clear();
+        conn.outOffset = 0;
+        for (const auto& frame : conn.eventQueue) {
+            conn.outBuffer += *frame;
+        }
+        conn.eventQueue.clear();
+        
+        if (!flushOutput(conn)) {
+            return; // 连接已关闭，或等待可写事件后在 finishWrite 中继续
+        }
+        conn.outBuffer.clear();
+        conn.outOffset = 0;
+        conn.lastWrite = std::chrono::steady_clock::now();
+    }
+    updateInterest(conn);
+}
+
+// 长时间没有事件时发送注释行，防止代理或客户端因空闲断开
+void HttpServer::sendHeartbeats(std::chrono::steady_clock::time_point now) {
+    if (mEventSubscribers.empty()) {
+        return;
+    }
+    static const EventFrame heartbeatFrame = std::make_shared<const std::string>(": ping\n\n");
+    auto interval = std::chrono::milliseconds(std::max(1000, mMod->getConfig().sseHeartbeatInterval));
+    
+    std::vector<net::Socket> subscribers(mEventSubscribers.begin(), mEventSubscribers.end());
+    for (auto socket : subscribers) {
+        auto it = mConnections.find(socket);
+        if (it == mConnections.end()) {
+            continue;
+        }
+        HttpConnection& conn = *it->second;
+        if (conn.eventQueue.empty() && conn.outOffset >= conn.outBuffer.size() && now - conn.lastWrite >= interval) {
+            conn.eventQueue.push_back(heartbeatFrame);
+            pumpEvents(conn);
+        }
+    }
+}
+
+// ==================== WebSocket ====================
+
+void HttpServer::notifyWebSockets() {
+    mWebSocketsDirty = true;
+    if (mRunning && mPoller) {
+        mPoller->wakeup();
+    }
+}
+
+void HttpServer::openWebSocket(HttpConnection& conn, std::shared_ptr<WebSocketSession> session) {
+    conn.webSocket = std::move(session);
+    conn.closeAfterWrite = false;
+    conn.wsLastPing = std::chrono::steady_clock::now();
+    mWebSockets.insert(conn.socket);
+    LOG_DEBUG(mMod->getSelf().getLogger(), "[HTTP] Connection #{} upgraded to WebSocket ({} open)", conn.id,
+              mWebSockets.size());
+    
+    // 101 响应已在 outBuffer 中，会话的首批消息排在它之后
+    std::vector<std::string> messages;
+    conn.webSocket->onOpen(messages);
+    sendWebSocketMessages(conn, messages);
+}
+
+void HttpServer::readWebSocket(HttpConnection& conn) {
+    auto& logger = mMod->getSelf().getLogger();
+    
+    // 已发出关闭帧，之后收到的数据都丢弃
+    if (conn.closeAfterWrite) {
+        conn.inBuffer->clear();
+        return;
+    }
+    
+    std::vector<std::string> messages;
+    while (true) {
+        WebSocketFrame frame;
+        auto result = conn.wsReader.read(*conn.inBuffer, frame);
+        conn.inBuffer->erase(0, conn.wsReader.consumed());
+        if (result == WebSocketReader::Result::Incomplete) {
+            break;
+        }
+        if (result == WebSocketReader::Result::Error) {
+            LOG_DEBUG(logger, "[HTTP] WebSocket #{} protocol error, closing with {}", conn.id,
+                      conn.wsReader.errorCode());
+            sendWebSocketMessages(conn, messages);
+            closeWebSocket(conn, conn.wsReader.errorCode());
+            return;
+        }
+        
+        switch (frame.opcode) {
+        case WebSocketOpcode::Text:
+            try {
+                conn.webSocket->onMessage(frame.payload, messages);
+            } catch (const std::exception& e) {
+                LOG_ERROR(logger, "[HTTP] WebSocket #{} message handler exception: {}", conn.id, e.what());
+            }
+            break;
+        case WebSocketOpcode::Ping:
+            conn.outBuffer += encodeWebSocketFrame(WebSocketOpcode::Pong, frame.payload);
+            break;
+        case WebSocketOpcode::Pong:
+            break; // lastActive 已在收到数据时更新
+        case WebSocketOpcode::Close: {
+            // 回显对方的状态码后关闭 (读取时已校验)，没有状态码时以 1000 回应
+            uint16_t code = ws_close::Normal;
+            if (frame.payload.size() >= 2) {
+                code = static_cast<uint16_t>((uint8_t(frame.payload[0]) << 8) | uint8_t(frame.payload[1]));
+            }
+            LOG_TRACE(logger, "[HTTP] WebSocket #{} closed by client ({})", conn.id, code);
+            sendWebSocketMessages(conn, messages);
+            closeWebSocket(conn, code);
+            return;
+        }
+        default:
+            sendWebSocketMessages(conn, messages);
+            closeWebSocket(conn, ws_close::UnsupportedData);
+            return;
+        }
+    }
+    
+    sendWebSocketMessages(conn, messages);
+    
+    // 客户端只发不收时，回复 (pong 等) 会一直堆积，超过上限直接断开
+    size_t limit = static_cast<size_t>(std::max(1024, mMod->getConfig().wsSendBufferLimit));
+    if (conn.outBuffer.size() - conn.outOffset > limit * 4) {
+        LOG_DEBUG(logger, "[HTTP] WebSocket #{} is not reading, dropping connection", conn.id);
+        closeConnection(conn.socket);
+        return;
+    }
+    flushWebSocket(conn);
+}
+
+// 让会话推送增量；发送缓冲区超过上限时推迟到缓冲区发送完毕，期间的多次变更会合并成一次
+void HttpServer::pollWebSocket(HttpConnection& conn) {
+    if (conn.closeAfterWrite) {
+        return;
+    }
+    size_t limit = static_cast<size_t>(std::max(1024, mMod->getConfig().wsSendBufferLimit));
+    if (conn.outBuffer.size() - conn.outOffset >= limit) {
+        conn.wsPollPending = true;
+        return;
+    }
+    conn.wsPollPending = false;
+    
+    std::vector<std::string> messages;
+    try {
+        conn.webSocket->onPoll(messages);
+    } catch (const std::exception& e) {
+        LOG_ERROR(mMod->getSelf().getLogger(), "[HTTP] WebSocket #{} poll exception: {}", conn.id, e.what());
+    }
+    sendWebSocketMessages(conn, messages);
+    flushWebSocket(conn);
+}
+
+// 把消息编码成文本帧追加到发送缓冲区 (不立即发送)
+void HttpServer::sendWebSocketMessages(HttpConnection& conn, std::vector<std::string>& messages) {
+    if (messages.empty()) {
+        return;
+    }
+    // 已发送的前缀过长时压缩缓冲区，避免持续推送时 outBuffer 无限增长
+    if (conn.outOffset > 0 && conn.outOffset * 2 >= conn.outBuffer.size()) {
+        conn.outBuffer.erase(0, conn.outOffset);
+        conn.outOffset = 0;
+    }
+    for (const auto& message : messages) {
+        conn.outBuffer += encodeWebSocketFrame(WebSocketOpcode::Text, message);
+    }
+    messages.clear();
+}
+
+void HttpServer::closeWebSocket(HttpConnection& conn, uint16_t code) {
+    conn.outBuffer += encodeWebSocketClose(code);
+    conn.closeAfterWrite = true;
+    if (flushOutput(conn)) {
+        finishWrite(conn);
+    }
+}
+
+void HttpServer::flushWebSocket(HttpConnection& conn) {
+    if (conn.outOffset < conn.outBuffer.size() && flushOutput(conn)) {
+        finishWrite(conn);
+    }
+}
+
+// 定期发送 ping；超过两个周期没有收到任何数据 (包括 pong) 则认为连接已失效
+void HttpServer::pingWebSockets(std::chrono::steady_clock::time_point now) {
+    if (mWebSockets.empty()) {
+        return;
+    }
+    auto& logger = mMod->getSelf().getLogger();
+    auto interval = std::chrono::milliseconds(std::max(1000, mMod->getConfig().wsPingInterval));
+    
+    std::vector<net::Socket> sockets(mWebSockets.begin(), mWebSockets.end());
+    for (auto socket : sockets) {
+        auto it = mConnections.find(socket);
+        if (it == mConnections.end()) {
+            continue;
+        }
+        HttpConnection& conn = *it->second;
+        if (now - conn.lastActive >= interval * 2) {
+            LOG_DEBUG(logger, "[HTTP] WebSocket #{} timed out waiting for pong", conn.id);
+            closeConnection(socket);
+            continue;
+        }
+        if (now - conn.wsLastPing >= interval && !conn.closeAfterWrite) {
+            conn.wsLastPing = now;
+            conn.outBuffer += encodeWebSocketFrame(WebSocketOpcode::Ping, {});
+            flushWebSocket(conn);
+        }
+    }
+}
+
+// ==================== 请求处理 (工作线程) ====================
+
+std::string HttpServer::processRequest(HttpRequest& request, int requestsServed, HttpCompletion& completion) {
+    auto& logger = mMod->getSelf().getLogger();
+    
+    LOG_TRACE(logger, "[HTTP] Request line: {} {}{}{} {} ({} headers, body: {} bytes)", request.method, request.path,
+              request.query.empty() ? "" : "?", request.query, request.version, request.headers.size(),
+              request.body.size());
     
-    // 解析请求
-    HttpRequest request = parseRequest(rawRequest);
     HttpResponse response;
+    bool keepAlive = shouldKeepAlive(request, requestsServed);
     
     // 添加 CORS 头
     if (mMod->getConfig().enableCors) {
@@ -195,88 +1137,161 @@ void HttpServer::handleClient(SOCKET clientSocket) {
     // 处理 OPTIONS 预检请求
     if (request.method == "OPTIONS") {
         response.setStatus(204, "No Content");
+        completion.routeSlot = mRouter.routes().size();
+        countRequest(completion.routeSlot, response.statusCode);
     } else {
-        // 处理请求
-        handleRequest(request, response);
+        // 处理请求；ETag 需要区分格式，所以在调用处理函数前协商
+        if (mMod->getConfig().enableBinaryFormats) {
+            response.format = negotiateBodyFormat(request.getHeader("Accept"));
+        }
+        completion.routeSlot = handleRequest(request, response);
     }
     
-    // 构建并发送响应
-    std::string responseStr = buildResponse(response);
-    logger.trace("[HTTP] Response size: {} bytes", responseStr.length());
-    int bytesSent = send(clientSocket, responseStr.c_str(), static_cast<int>(responseStr.length()), 0);
-    
-    if (bytesSent == SOCKET_ERROR) {
-        logger.warn("[HTTP] Failed to send response: {}", WSAGetLastError());
+    // SSE 流：连接保持打开，由事件循环继续推送
+    if (response.eventStream && response.statusCode == 200) {
+        keepAlive = true;
+        completion.eventStream = true;
+        std::string_view lastEventId = request.getHeader("Last-Event-ID");
+        if (lastEventId.empty()) {
+            lastEventId = request.getParam("lastEventId");
+        }
+        auto [ptr, ec] = std::from_chars(lastEventId.data(), lastEventId.data() + lastEventId.size(),
+                                         completion.lastEventId);
+        completion.resume = !lastEventId.empty() && ec == std::errc() && ptr == lastEventId.data() + lastEventId.size();
+    } else if (response.webSocket && response.statusCode == 101) {
+        keepAlive = true;
+        completion.webSocket = response.webSocket;
     } else {
-        logger.trace("[HTTP] Sent {} bytes to client", bytesSent);
+        response.eventStream = false;
+        response.webSocket.reset();
     }
+    completion.keepAlive = keepAlive;
     
-    logger.debug("[HTTP] Response: {} {} (body: {} bytes)", 
-                 response.statusCode, response.statusText, response.body.length());
+    // 构建响应
+    std::chrono::steady_clock::time_point serializeStart;
+    if (mLatency) serializeStart = std::chrono::steady_clock::now();
+    if (!response.eventStream && !response.webSocket) {
+        convertResponseFormat(response);
+        compressResponse(request, response);
+    }
+    std::string responseStr = buildResponse(response, keepAlive);
+    if (mLatency) {
+        mLatency->record(LatencyPhase::Serialize, elapsedMicros(serializeStart, std::chrono::steady_clock::now()));
+    }
+    LOG_TRACE(logger, "[HTTP] Response size: {} bytes", responseStr.length());
+    LOG_DEBUG(logger, "[HTTP] Response: {} {} (body: {} bytes)", 
+              response.statusCode, response.statusText, response.getBody().length());
+    return responseStr;
+}
+
+// 把 JSON 响应体转换为协商出的二进制格式；共享响应体的转换结果缓存在响应体旁边，同一版本只转换一次
+void HttpServer::convertResponseFormat(HttpResponse& response) const {
+    if (!mMod->getConfig().enableBinaryFormats) {
+        return;
+    }
+    
+    // 304 也要带上 Vary，与对应的 200 响应一致
+    auto contentType = response.headers.find("Content-Type");
+    bool isJson = contentType != response.headers.end() && contentType->second.starts_with("application/json");
+    if (response.statusCode == 304 || isJson) {
+        addVary(response, "Accept");
+    }
+    if (!isJson || response.format == BodyFormat::Json || !statusAllowsBody(response.statusCode)) {
+        return;
+    }
     
-    closesocket(clientSocket);
-    logger.trace("[HTTP] Client connection closed");
+    if (response.sharedBody) {
+        auto converted = response.sharedBody->transcoded(response.format);
+        if (!converted) return;
+        response.sharedBody = std::move(converted);
+        response.encodedBody.reset();
+    } else {
+        std::string converted;
+        if (!transcodeJson(response.body, response.format, converted)) return;
+        response.body = std::move(converted);
+    }
+    contentType->second = bodyFormatContentType(response.format);
 }
 
-HttpRequest HttpServer::parseRequest(const std::string& rawRequest) {
-    HttpRequest request;
-    std::istringstream stream(rawRequest);
-    std::string line;
+// 按 Accept-Encoding 压缩响应体；共享响应体的压缩结果缓存在响应体旁边，同一版本只压缩一次
+void HttpServer::compressResponse(const HttpRequest& request, HttpResponse& response) const {
+    const auto& config = mMod->getConfig();
     
-    // 解析请求行
-    if (std::getline(stream, line)) {
-        // 移除可能的 \r
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+    // 304 的 ETag 和 Vary 要与此时的 200 响应一致：客户端缓存的是压缩版本时 (匹配的 ETag 带编码后缀)，
+    // 内容一定可以压缩，换成这次协商出的编码的后缀
+    if (response.statusCode == 304) {
+        auto etag = response.headers.find("ETag");
+        if (etag != response.headers.end() && removeEncodingTag(etag->second)) {
+            ContentEncoding encoding = config.enableCompression
+                                           ? negotiateEncoding(request.getHeader("Accept-Encoding"))
+                                           : ContentEncoding::Identity;
+            insertETagSuffix(etag->second, contentEncodingTag(encoding));
         }
-        
-        std::istringstream lineStream(line);
-        std::string path;
-        lineStream >> request.method >> path;
-        
-        // 分离 path 和 query
-        size_t queryPos = path.find('?');
-        if (queryPos != std::string::npos) {
-            request.path = path.substr(0, queryPos);
-            request.query = path.substr(queryPos + 1);
-        } else {
-            request.path = path;
+        if (config.enableCompression) {
+            addVary(response, "Accept-Encoding");
         }
+        return;
+    }
+    if (!config.enableCompression || response.headers.count("Content-Encoding")) {
+        return;
+    }
+    std::string_view body = response.getBody();
+    auto contentType = response.headers.find("Content-Type");
+    if (!statusAllowsBody(response.statusCode) || contentType == response.headers.end() ||
+        !isCompressibleType(contentType->second)) {
+        return;
+    }
+    if (body.size() < static_cast<size_t>(std::max(0, config.compressionMinSize))) {
+        return;
     }
+    addVary(response, "Accept-Encoding");
     
-    // 解析头部
-    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-        if (line.back() == '\r') {
-            line.pop_back();
-        }
-        if (line.empty()) break;
-        
-        size_t colonPos = line.find(':');
-        if (colonPos != std::string::npos) {
-            std::string key = line.substr(0, colonPos);
-            std::string value = line.substr(colonPos + 1);
-            // 去除前导空格
-            while (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
-            }
-            request.headers[key] = value;
-        }
+    ContentEncoding encoding = negotiateEncoding(request.getHeader("Accept-Encoding"));
+    if (encoding == ContentEncoding::Identity) {
+        return;
+    }
+    if (response.sharedBody && !response.encodedBody) {
+        response.encodedBody = response.sharedBody->encoded(encoding);
+        if (!response.encodedBody) return;
+    } else {
+        std::string compressed;
+        if (!compressBody(encoding, body, compressed) || compressed.size() >= body.size()) return;
+        response.body = std::move(compressed);
+        response.sharedBody.reset();
+        response.encodedBody.reset();
     }
+    response.headers["Content-Encoding"] = contentEncodingName(encoding);
     
-    // 读取 body（如果有）
-    std::string remaining;
-    while (std::getline(stream, line)) {
-        remaining += line + "\n";
+    // 压缩后是不同的字节序列，与格式一样在引号内加上编码后缀，保持强 ETag
+    auto etag = response.headers.find("ETag");
+    if (etag != response.headers.end()) {
+        insertETagSuffix(etag->second, contentEncodingTag(encoding));
     }
-    if (!remaining.empty() && remaining.back() == '\n') {
-        remaining.pop_back();
+}
+
+bool HttpServer::shouldKeepAlive(const HttpRequest& request, int requestsServed) const {
+    const auto& config = mMod->getConfig();
+    if (!config.enableKeepAlive || !mRunning) {
+        return false;
+    }
+    if (config.keepAliveMaxRequests > 0 && requestsServed >= config.keepAliveMaxRequests) {
+        return false;
     }
-    request.body = remaining;
     
-    return request;
+    // HTTP/1.1 默认持久连接，HTTP/1.0 需要显式声明 keep-alive
+    std::string connection(request.getHeader("Connection"));
+    std::transform(connection.begin(), connection.end(), connection.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (connection.find("close") != std::string::npos) {
+        return false;
+    }
+    if (request.version == "HTTP/1.1") {
+        return true;
+    }
+    return connection.find("keep-alive") != std::string::npos;
 }
 
-std::string HttpServer::buildResponse(const HttpResponse& response) {
+std::string HttpServer::buildResponse(const HttpResponse& response, bool keepAlive) {
     std::ostringstream stream;
     
     // 状态行
@@ -287,73 +1302,308 @@ std::string HttpServer::buildResponse(const HttpResponse& response) {
         stream << key << ": " << value << "\r\n";
     }
     
-    // Content-Length
-    stream << "Content-Length: " << response.body.length() << "\r\n";
-    stream << "Connection: close\r\n";
+    // Content-Length (1xx/204/304 不允许携带 body，也不发送 Content-Length)
+    bool bodyAllowed = statusAllowsBody(response.statusCode);
+    std::string_view body = bodyAllowed ? response.getBody() : std::string_view{};
+    if (bodyAllowed && !response.eventStream) {
+        stream << "Content-Length: " << body.length() << "\r\n";
+    }
+    if (response.eventStream) {
+        // 事件流没有长度，直到连接关闭
+        stream << "Connection: keep-alive\r\n";
+    } else if (response.webSocket) {
+        // 握手响应的 Connection: Upgrade 已在头部中
+    } else if (keepAlive) {
+        const auto& config = mMod->getConfig();
+        stream << "Connection: keep-alive\r\n";
+        stream << "Keep-Alive: timeout=" << std::max(1, config.keepAliveTimeout / 1000);
+        if (config.keepAliveMaxRequests > 0) {
+            stream << ", max=" << config.keepAliveMaxRequests;
+        }
+        stream << "\r\n";
+    } else {
+        stream << "Connection: close\r\n";
+    }
     
     // 空行
     stream << "\r\n";
     
     // Body
-    stream << response.body;
+    stream << body;
     
     return stream.str();
 }
 
-void HttpServer::handleRequest(const HttpRequest& request, HttpResponse& response) {
-    auto& logger = mMod->getSelf().getLogger();
-    
-    logger.debug("[HTTP] {} {} (query: {})", request.method, request.path, 
-                 request.query.empty() ? "<none>" : request.query);
-    logger.trace("[HTTP] Request headers count: {}", request.headers.size());
+bool applyETag(const HttpRequest& request, HttpResponse& response, const std::string& etag) {
+    // 不同格式是不同的表示，ETag 不能相同：在结尾的引号前加上格式后缀 (压缩时 compressResponse 再加上编码后缀)
+    std::string& tagged = response.headers["ETag"];
+    tagged = etag;
+    insertETagSuffix(tagged, bodyFormatTag(response.format));
+    response.headers["Cache-Control"] = "no-cache";
     
-    RouteHandler handler = nullptr;
-    
-    {
-        std::lock_guard<std::mutex> lock(mRoutesMutex);
+    // If-None-Match 使用弱比较 (RFC 9110 13.1.2)，可能是逗号分隔的列表或 *；
+    // 客户端缓存的可能是任意一种压缩版本，去掉编码后缀后再比较
+    std::string_view ifNoneMatch = request.getHeader("If-None-Match");
+    bool matched = false;
+    std::string matchedTag;
+    while (!ifNoneMatch.empty() && !matched) {
+        size_t commaPos = ifNoneMatch.find(',');
+        std::string_view candidate = ifNoneMatch.substr(0, commaPos);
+        ifNoneMatch = commaPos == std::string_view::npos ? std::string_view{} : ifNoneMatch.substr(commaPos + 1);
         
-        if (request.method == "GET") {
-            auto it = mGetRoutes.find(request.path);
-            if (it != mGetRoutes.end()) {
-                handler = it->second;
-                logger.trace("[HTTP] Found GET handler for {}", request.path);
-            }
-        } else if (request.method == "POST") {
-            auto it = mPostRoutes.find(request.path);
-            if (it != mPostRoutes.end()) {
-                handler = it->second;
-                logger.trace("[HTTP] Found POST handler for {}", request.path);
-            }
+        while (!candidate.empty() && candidate.front() == ' ') candidate.remove_prefix(1);
+        while (!candidate.empty() && candidate.back() == ' ') candidate.remove_suffix(1);
+        if (candidate.substr(0, 2) == "W/") candidate.remove_prefix(2);
+        if (candidate == "*") {
+            matched = true;
+            break;
+        }
+        matchedTag = candidate;
+        removeEncodingTag(matchedTag);
+        if (matchedTag == tagged) {
+            matched = true;
+            // 保留客户端缓存版本的编码后缀，compressResponse 据此换成本次协商的编码
+            tagged = candidate;
         }
     }
     
-    if (handler) {
-        logger.trace("[HTTP] Invoking handler for {} {}", request.method, request.path);
+    if (matched) {
+        response.setStatus(304, "Not Modified");
+        response.headers.erase("Content-Type");
+        response.body.clear();
+        response.sharedBody.reset();
+        response.encodedBody.reset();
+    }
+    return matched;
+}
+
+// 判断逗号分隔的头部值中是否包含某个 token (不区分大小写)，例如 Connection: keep-alive, Upgrade
+static bool headerHasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t commaPos = value.find(',');
+        std::string_view item = value.substr(0, commaPos);
+        value = commaPos == std::string_view::npos ? std::string_view{} : value.substr(commaPos + 1);
+        
+        while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+        if (equalsIgnoreCase(item, token)) return true;
+    }
+    return false;
+}
+
+bool acceptWebSocket(const HttpRequest& request, HttpResponse& response, std::shared_ptr<WebSocketSession> session) {
+    std::string_view key = request.getHeader("Sec-WebSocket-Key");
+    if (!headerHasToken(request.getHeader("Upgrade"), "websocket") ||
+        !headerHasToken(request.getHeader("Connection"), "upgrade") || key.empty()) {
+        response.setStatus(426, "Upgrade Required");
+        response.headers["Upgrade"] = "websocket";
+        response.setJson("{\"error\": \"WebSocket upgrade required\"}");
+        return false;
+    }
+    if (request.getHeader("Sec-WebSocket-Version") != "13") {
+        response.setStatus(426, "Upgrade Required");
+        response.headers["Sec-WebSocket-Version"] = "13";
+        response.setJson("{\"error\": \"Unsupported WebSocket version\"}");
+        return false;
+    }
+    
+    response.setStatus(101, "Switching Protocols");
+    response.headers.erase("Content-Type");
+    response.headers["Upgrade"] = "websocket";
+    response.headers["Connection"] = "Upgrade";
+    response.headers["Sec-WebSocket-Accept"] = computeWebSocketAccept(key);
+    response.body.clear();
+    response.sharedBody.reset();
+    response.encodedBody.reset();
+    response.webSocket = std::move(session);
+    return true;
+}
+
+// 返回请求所属的统计槽位 (路由 ID，未匹配时为路由数)
+size_t HttpServer::handleRequest(HttpRequest& request, HttpResponse& response) {
+    auto& logger = mMod->getSelf().getLogger();
+    
+    LOG_DEBUG(logger, "[HTTP] {} {} (query: {})", request.method, request.path, 
+              request.query.empty() ? "<none>" : request.query);
+    LOG_TRACE(logger, "[HTTP] Request headers count: {}", request.headers.size());
+    
+    // 路由表已冻结，查找不加锁、不复制 handler
+    auto match = mRouter.match(parseHttpMethod(request.method), request.path, request.pathParams);
+    size_t routeSlot = match.route ? match.route->id : mRouter.routes().size();
+    std::chrono::steady_clock::time_point handlerStart;
+    if (mLatency) handlerStart = std::chrono::steady_clock::now();
+    
+    if (match.route) {
+        LOG_TRACE(logger, "[HTTP] Invoking handler for {} {} (route: {})", request.method, request.path,
+                  match.route->pattern);
         try {
-            handler(request, response);
-            logger.trace("[HTTP] Handler completed successfully");
+            match.route->handler(request, response);
+            LOG_TRACE(logger, "[HTTP] Handler completed successfully");
         } catch (const std::exception& e) {
-            logger.error("[HTTP] Handler exception for {} {}: {}", request.method, request.path, e.what());
+            LOG_ERROR(logger, "[HTTP] Handler exception for {} {}: {}", request.method, request.path, e.what());
             response.setStatus(500, "Internal Server Error");
             response.setJson("{\"error\": \"Internal server error\"}");
         }
+    } else if (match.allowedMethods != 0) {
+        LOG_DEBUG(logger, "[HTTP] Method {} not allowed for {}", request.method, request.path);
+        response.setStatus(405, "Method Not Allowed");
+        response.headers["Allow"] = Router::formatAllow(match.allowedMethods);
+        response.setJson("{\"error\": \"Method not allowed\"}");
     } else {
-        logger.debug("[HTTP] No handler found for {} {}", request.method, request.path);
+        LOG_DEBUG(logger, "[HTTP] No handler found for {} {}", request.method, request.path);
         response.setStatus(404, "Not Found");
         response.setJson("{\"error\": \"Endpoint not found\"}");
     }
+    countRequest(routeSlot, response.statusCode);
+    
+    if (mLatency) {
+        uint64_t micros = elapsedMicros(handlerStart, std::chrono::steady_clock::now());
+        mLatency->record(LatencyPhase::Handler, micros);
+        mLatency->recordRouteHandler(routeSlot, micros);
+    }
+    return routeSlot;
+}
+
+std::string HttpServer::routeLabel(size_t routeSlot) const {
+    const auto& routes = mRouter.routes();
+    if (routeSlot >= routes.size()) {
+        return "unmatched";
+    }
+    const auto& route = *routes[routeSlot];
+    return std::string(route.method == HttpMethod::Get ? "GET " : "POST ") + route.pattern;
+}
+
+// 在请求行的 query 中查找参数 (已做百分号解码)，不存在时返回空字符串
+static std::string findQueryParam(std::string_view requestLine, std::string_view name) {
+    size_t targetStart = requestLine.find(' ');
+    size_t targetEnd = requestLine.rfind(' ');
+    if (targetStart == std::string_view::npos || targetEnd <= targetStart) {
+        return {};
+    }
+    std::string_view target = requestLine.substr(targetStart + 1, targetEnd - targetStart - 1);
+    size_t queryPos = target.find('?');
+    if (queryPos == std::string_view::npos) {
+        return {};
+    }
+    std::string_view query = target.substr(queryPos + 1);
+    while (!query.empty()) {
+        size_t ampPos = query.find('&');
+        std::string_view pair = query.substr(0, ampPos);
+        query = ampPos == std::string_view::npos ? std::string_view{} : query.substr(ampPos + 1);
+        size_t eqPos = pair.find('=');
+        if (pair.substr(0, eqPos) == name && eqPos != std::string_view::npos) {
+            return percentDecode(pair.substr(eqPos + 1));
+        }
+    }
+    return {};
+}
+
+// 按客户端 IP 和 token 限流；只看请求行，token 与 validateToken 一样取自 query 参数
+bool HttpServer::checkRateLimit(const HttpConnection& conn, std::string_view requestLine,
+                                std::chrono::milliseconds& retryAfter) {
+    // 高优先级路由 (/health 等) 不限流：监控探针与其他客户端共享 IP 或 token 时也不会收到 429
+    size_t methodEnd = requestLine.find(' ');
+    if (methodEnd != std::string_view::npos) {
+        std::string_view target = requestLine.substr(methodEnd + 1);
+        target = target.substr(0, target.find_first_of(" ?\r"));
+        PathParams params;
+        auto match = mRouter.match(parseHttpMethod(requestLine.substr(0, methodEnd)), target, params);
+        if (match.route && match.route->priority == RoutePriority::High) {
+            return true;
+        }
+    }
+    
+    const auto& config = mMod->getConfig();
+    auto now = std::chrono::steady_clock::now();
+    auto rule = [](int rate, int burst) {
+        return RateLimitRule{static_cast<uint32_t>(std::max(0, rate)),
+                             static_cast<uint32_t>(std::clamp(burst, 1, 1000000))};
+    };
+    
+    // remoteAddr 形如 ip:port，同一 IP 的不同连接共享一个桶
+    std::string_view remote = conn.remoteAddr;
+    std::string key = "ip:";
+    key += remote.substr(0, remote.rfind(':'));
+    if (!mRateLimiter->tryAcquire(key, rule(config.rateLimitPerIp, config.rateLimitIpBurst), now, retryAfter)) {
+        return false;
+    }
+    
+    std::string token = findQueryParam(requestLine, "token");
+    if (token.empty()) {
+        return true;
+    }
+    key = "token:" + token;
+    return mRateLimiter->tryAcquire(key, rule(config.rateLimitPerToken, config.rateLimitTokenBurst), now, retryAfter);
+}
+
+void HttpServer::countRequest(size_t routeSlot, int statusCode) {
+    size_t index = routeSlot * kStatusSlots + statusSlot(statusCode);
+    if (index < mRequestCountSlots) {
+        mRequestCounts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HttpServer::appendMetrics(std::string& out) const {
+    out += "# HELP serverinfo_http_requests_total HTTP requests handled, by route and status code.\n";
+    out += "# TYPE serverinfo_http_requests_total counter\n";
+    const auto& routes = mRouter.routes();
+    for (size_t slot = 0; slot < mRequestCountSlots; ++slot) {
+        uint64_t count = mRequestCounts[slot].load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        size_t route = slot / kStatusSlots;
+        size_t status = slot % kStatusSlots;
+        out += "serverinfo_http_requests_total{method=\"";
+        out += route < routes.size() ? (routes[route]->method == HttpMethod::Get ? "GET" : "POST") : "";
+        out += "\",route=\"";
+        out += route < routes.size() ? routes[route]->pattern : "unmatched";
+        out += "\",status=\"";
+        out += status < std::size(kCountedStatuses) ? std::to_string(kCountedStatuses[status]) : "other";
+        out += "\"} ";
+        out += std::to_string(count);
+        out += "\n";
+    }
+    
+    out += "# HELP serverinfo_http_connections_open Currently open HTTP connections (including SSE and WebSocket).\n";
+    out += "# TYPE serverinfo_http_connections_open gauge\n";
+    out += "serverinfo_http_connections_open " + std::to_string(mOpenConnections.load(std::memory_order_relaxed)) + "\n";
+    out += "# HELP serverinfo_http_connections_shed_total Connections rejected with 503 because maxConnections was reached.\n";
+    out += "# TYPE serverinfo_http_connections_shed_total counter\n";
+    out += "serverinfo_http_connections_shed_total " + std::to_string(mShedConnections.load(std::memory_order_relaxed)) +
+           "\n";
+    
+    if (mRateLimiter) {
+        out += "# HELP serverinfo_http_rate_limited_total Requests rejected with 429 by the rate limiter.\n";
+        out += "# TYPE serverinfo_http_rate_limited_total counter\n";
+        out += "serverinfo_http_rate_limited_total " + std::to_string(mRateLimiter->rejectedCount()) + "\n";
+        out += "# HELP serverinfo_http_rate_limit_clients Clients (IPs and tokens) tracked by the rate limiter.\n";
+        out += "# TYPE serverinfo_http_rate_limit_clients gauge\n";
+        out += "serverinfo_http_rate_limit_clients " + std::to_string(mRateLimiter->trackedCount()) + "\n";
+    }
 }
 
-void HttpServer::get(const std::string& path, RouteHandler handler) {
-    std::lock_guard<std::mutex> lock(mRoutesMutex);
-    mGetRoutes[path] = std::move(handler);
-    mMod->getSelf().getLogger().debug("[HTTP] Registered route: GET {}", path);
+void HttpServer::get(const std::string& path, RouteHandler handler, RoutePriority priority) {
+    addRoute(HttpMethod::Get, path, std::move(handler), priority);
 }
 
-void HttpServer::post(const std::string& path, RouteHandler handler) {
-    std::lock_guard<std::mutex> lock(mRoutesMutex);
-    mPostRoutes[path] = std::move(handler);
-    mMod->getSelf().getLogger().debug("[HTTP] Registered route: POST {}", path);
+void HttpServer::post(const std::string& path, RouteHandler handler, RoutePriority priority) {
+    addRoute(HttpMethod::Post, path, std::move(handler), priority);
+}
+
+void HttpServer::addRoute(HttpMethod method, const std::string& path, RouteHandler handler, RoutePriority priority) {
+    auto& logger = mMod->getSelf().getLogger();
+    const char* methodName = method == HttpMethod::Get ? "GET" : "POST";
+    if (mRouter.isFrozen()) {
+        LOG_ERROR(logger, "[HTTP] Cannot register {} {}: routes are frozen after start()", methodName, path);
+        return;
+    }
+    if (!mRouter.add(method, path, std::move(handler), priority)) {
+        LOG_ERROR(logger, "[HTTP] Invalid or duplicate route: {} {}", methodName, path);
+        return;
+    }
+    LOG_DEBUG(logger, "[HTTP] Registered route: {} {}{}", methodName, path,
+              priority == RoutePriority::High ? " (high priority)" : "");
 }
 
 } // namespace serverinfo_rest
@@ -1,30 +1,37 @@
 #pragma once
 
+#include "mod/Compression.h"
+#include "mod/EventStream.h"
+#include "mod/HttpParser.h"
+#include "mod/LatencyStats.h"
+#include "mod/RateLimiter.h"
+#include "mod/Router.h"
+#include "mod/Socket.h"
+#include "mod/TimerWheel.h"
+#include "mod/WebSocket.h"
+
 #include <string>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib")
-#endif
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace serverinfo_rest {
 
 class ServerInfoRestMod;
+class ThreadPool;
 
-// 简单的 HTTP 请求结构
-struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::string query;
-    std::map<std::string, std::string> headers;
-    std::string body;
-};
+namespace net {
+class Poller;
+}
 
 // 简单的 HTTP 响应结构
 struct HttpResponse {
@@ -32,20 +39,119 @@ struct HttpResponse {
     std::string statusText = "OK";
     std::map<std::string, std::string> headers;
     std::string body;
+    std::shared_ptr<const EncodedBody> sharedBody; // 预序列化的共享响应体，设置后优先于 body
+    std::shared_ptr<const std::string> encodedBody; // sharedBody 缓存的压缩版本，设置后代替 sharedBody 发送
+    BodyFormat format = BodyFormat::Json;          // 按 Accept 协商的格式，处理函数照常输出 JSON，发送前再转换
+    bool eventStream = false;                      // 发送响应头后把连接切换为 SSE 推送
+    std::shared_ptr<WebSocketSession> webSocket;   // 101 响应发送后把连接交给该会话
     
     void setJson(const std::string& json) {
         headers["Content-Type"] = "application/json; charset=utf-8";
         body = json;
+        sharedBody.reset();
+        encodedBody.reset();
+    }
+    
+    // 直接引用缓存中已序列化好的 JSON，不复制内容
+    void setJson(std::shared_ptr<const EncodedBody> json) {
+        headers["Content-Type"] = "application/json; charset=utf-8";
+        body.clear();
+        sharedBody = std::move(json);
+        encodedBody.reset();
+    }
+    
+    std::string_view getBody() const {
+        if (encodedBody) return *encodedBody;
+        return sharedBody ? std::string_view(sharedBody->identity()) : std::string_view(body);
     }
     
     void setStatus(int code, const std::string& text) {
         statusCode = code;
         statusText = text;
     }
+    
+    // 把响应切换为 Server-Sent Events 流，之后事件由事件循环推送
+    void startEventStream() {
+        headers["Content-Type"] = "text/event-stream; charset=utf-8";
+        headers["Cache-Control"] = "no-cache";
+        headers["X-Accel-Buffering"] = "no";
+        body.clear();
+        sharedBody.reset();
+        encodedBody.reset();
+        eventStream = true;
+    }
 };
 
-// 路由处理函数类型
-using RouteHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+// 为响应设置 ETag (按 response.format 加上格式后缀，压缩时再加编码后缀)；如果请求的 If-None-Match 与之匹配
+// (忽略其中的编码后缀)，把响应改为 304 Not Modified 并返回 true
+bool applyETag(const HttpRequest& request, HttpResponse& response, const std::string& etag);
+
+// 校验 WebSocket 升级请求并生成 101 响应，成功后连接交给 session；请求不合法时设置 400/426 并返回 false
+bool acceptWebSocket(const HttpRequest& request, HttpResponse& response, std::shared_ptr<WebSocketSession> session);
+
+// 连接当前生效的超时类型，同一时间只有一个，决定超时定时器的时长
+enum class ConnectionDeadline : uint8_t {
+    None,   // 请求在工作线程中处理，或连接是 SSE / WebSocket
+    Header, // 接收请求行和请求头
+    Body,   // 接收请求体
+    Idle,   // keep-alive 连接等待下一个请求
+    Write   // 发送响应 (客户端没有及时读取)
+};
+
+// 事件循环中的一个客户端连接，只在事件循环线程中访问
+struct HttpConnection {
+    net::Socket socket = net::kInvalidSocket;
+    uint64_t id = 0;
+    std::string remoteAddr;
+    
+    // 已接收但尚未处理的字节 (可能包含多个流水线请求)
+    // 请求在工作线程处理期间，HttpRequest 中的视图指向这里，因此用 shared_ptr 保证连接提前关闭时缓冲区仍然有效
+    std::shared_ptr<std::string> inBuffer = std::make_shared<std::string>();
+    HttpParser parser;
+    std::string outBuffer;        // 待发送的响应
+    size_t outOffset = 0;         // outBuffer 中已发送的字节数
+    
+    int requestsServed = 0;
+    bool busy = false;            // 有请求正在工作线程中处理
+    bool closeAfterWrite = false; // 响应发送完毕后关闭连接
+    bool rateChecked = false;     // 当前请求已经通过限流检查
+    std::chrono::steady_clock::time_point lastActive;
+    
+    // 超时定时器 (tag 为 socket)；超时类型不变时不续期，慢速发送数据的客户端无法一直占用连接
+    ConnectionDeadline deadline = ConnectionDeadline::None;
+    TimerNode deadlineTimer;
+    
+    // 延迟统计 (仅在启用 /debug/stats 时记录)
+    std::chrono::steady_clock::time_point requestStart;  // 收到当前请求的第一个字节
+    std::chrono::steady_clock::time_point responseReady; // 事件循环取到响应
+    size_t routeSlot = SIZE_MAX;                         // 正在发送的响应所属路由，SIZE_MAX 表示没有
+    
+    // SSE 订阅状态
+    bool eventStream = false;
+    uint64_t eventCursor = 0;            // 已排入队列的最后一个事件 ID
+    std::deque<EventFrame> eventQueue;   // 等待发送的事件，超过上限时断开该订阅者
+    std::chrono::steady_clock::time_point lastWrite;
+    
+    // WebSocket 状态
+    std::shared_ptr<WebSocketSession> webSocket;
+    WebSocketReader wsReader;
+    bool wsPollPending = false;          // 因发送缓冲区超限而推迟的推送
+    std::chrono::steady_clock::time_point wsLastPing;
+};
+
+// 工作线程处理完的响应，交回事件循环发送
+struct HttpCompletion {
+    net::Socket socket;
+    uint64_t connectionId;
+    std::string data;
+    bool keepAlive;
+    bool eventStream = false;  // 响应是 SSE 流的开头
+    bool resume = false;       // 客户端带了 Last-Event-ID
+    uint64_t lastEventId = 0;
+    std::shared_ptr<WebSocketSession> webSocket{}; // 响应是 WebSocket 握手
+    size_t routeSlot = 0;
+    std::chrono::steady_clock::time_point completedAt{};
+};
 
 class HttpServer {
 public:
@@ -56,29 +162,120 @@ public:
     void stop();
     bool isRunning() const { return mRunning; }
 
-    // 注册路由
-    void get(const std::string& path, RouteHandler handler);
-    void post(const std::string& path, RouteHandler handler);
+    // 注册路由，必须在 start() 之前调用；路径支持 {name} / {id:int} 参数
+    // RoutePriority::High 的路由在事件循环中直接处理 (见 RoutePriority)
+    void get(const std::string& path, RouteHandler handler, RoutePriority priority = RoutePriority::Normal);
+    void post(const std::string& path, RouteHandler handler, RoutePriority priority = RoutePriority::Normal);
+    
+    // 在当前线程中按路由表执行一个内部子请求 (用于 /batch)，与普通请求一样计入路由统计
+    void dispatchSubrequest(HttpRequest& request, HttpResponse& response) { handleRequest(request, response); }
+
+    // 向所有 SSE 订阅者广播事件，可在任意线程调用，不会阻塞在慢客户端上
+    void publishEvent(std::string_view type, std::string_view data);
+
+    // 以 Prometheus 文本格式追加 HTTP 服务器自身的指标 (请求计数、连接数)，可在任意线程调用
+    void appendMetrics(std::string& out) const;
+
+    // 延迟统计，未启用 enableDebugStats 时为空
+    [[nodiscard]] const LatencyStats* latencyStats() const { return mLatency.get(); }
+    // 统计槽位对应的路由描述，例如 "GET /api/v1/players"
+    [[nodiscard]] std::string routeLabel(size_t routeSlot) const;
+
+    // 通知所有 WebSocket 会话数据可能已变化，可在任意线程调用；多次通知会合并为一次推送
+    void notifyWebSockets();
 
 private:
-    void serverLoop();
-    void handleClient(SOCKET clientSocket);
-    HttpRequest parseRequest(const std::string& rawRequest);
-    std::string buildResponse(const HttpResponse& response);
-    void handleRequest(const HttpRequest& request, HttpResponse& response);
+    // 事件循环 (运行在 mServerThread)
+    void eventLoop();
+    void acceptConnections();
+    void onReadable(HttpConnection& conn);
+    void onWritable(HttpConnection& conn);
+    void dispatchRequest(HttpConnection& conn);
+    bool flushOutput(HttpConnection& conn);
+    void finishWrite(HttpConnection& conn);
+    void drainCompletions();
+    void completeRequest(HttpCompletion& completion);
+    void shedConnection(net::Socket socket);
+    void expireIdleConnections();
+    void expireDeadlines(std::chrono::steady_clock::time_point now);
+    void setDeadline(HttpConnection& conn, ConnectionDeadline deadline);
+    void clearDeadline(HttpConnection& conn);
+    void closeConnection(net::Socket socket);
+    void updateInterest(HttpConnection& conn);
+    void rejectRequest(HttpConnection& conn, HttpResponse& response);
+    
+    // SSE 推送 (运行在事件循环线程)
+    void openEventStream(HttpConnection& conn, const HttpCompletion& completion);
+    void fanoutEvents();
+    void pumpEvents(HttpConnection& conn);
+    void sendHeartbeats(std::chrono::steady_clock::time_point now);
+    
+    // WebSocket (运行在事件循环线程)
+    void openWebSocket(HttpConnection& conn, std::shared_ptr<WebSocketSession> session);
+    void readWebSocket(HttpConnection& conn);
+    void pollWebSocket(HttpConnection& conn);
+    void sendWebSocketMessages(HttpConnection& conn, std::vector<std::string>& messages);
+    void closeWebSocket(HttpConnection& conn, uint16_t code);
+    void flushWebSocket(HttpConnection& conn);
+    void pingWebSockets(std::chrono::steady_clock::time_point now);
+    
+    // 请求处理 (运行在工作线程)
+    std::string processRequest(HttpRequest& request, int requestsServed, HttpCompletion& completion);
+    std::string buildResponse(const HttpResponse& response, bool keepAlive = false);
+    void convertResponseFormat(HttpResponse& response) const;
+    void compressResponse(const HttpRequest& request, HttpResponse& response) const;
+    bool shouldKeepAlive(const HttpRequest& request, int requestsServed) const;
+    size_t handleRequest(HttpRequest& request, HttpResponse& response);
+    void countRequest(size_t routeSlot, int statusCode);
+    bool checkRateLimit(const HttpConnection& conn, std::string_view requestLine,
+                        std::chrono::milliseconds& retryAfter);
+    void addRoute(HttpMethod method, const std::string& path, RouteHandler handler, RoutePriority priority);
 
     std::string mHost;
     int mPort;
     ServerInfoRestMod* mMod;
     
-    SOCKET mServerSocket = INVALID_SOCKET;
+    net::Socket mServerSocket = net::kInvalidSocket;
     std::atomic<bool> mRunning{false};
     std::thread mServerThread;
+    std::unique_ptr<net::Poller> mPoller;
+    std::unique_ptr<ThreadPool> mWorkerPool;
+    
+    // 连接表 (仅事件循环线程访问)
+    std::unordered_map<net::Socket, std::unique_ptr<HttpConnection>> mConnections;
+    uint64_t mNextConnectionId = 1;
+    uint64_t mTotalConnections = 0;
+    std::chrono::steady_clock::time_point mLastIdleScan;
+    
+    // 连接超时 (仅事件循环线程访问)
+    TimerWheel mTimers;
+    std::vector<uint64_t> mExpiredTimers; // 每个 tick 复用，避免分配
+    
+    // 工作线程 -> 事件循环的完成队列
+    std::mutex mCompletionMutex;
+    std::vector<HttpCompletion> mCompletions;
+    
+    // 路由表 (start() 时冻结，之后只读)
+    Router mRouter;
+    
+    // 按 (路由, 状态码) 统计的请求数，start() 时按路由数分配，之后只做无锁自增
+    // 最后一个路由槽位用于没有匹配到路由的请求
+    std::unique_ptr<std::atomic<uint64_t>[]> mRequestCounts;
+    size_t mRequestCountSlots = 0;
+    std::atomic<size_t> mOpenConnections{0};
+    std::atomic<uint64_t> mShedConnections{0}; // 超过 maxConnections 被直接拒绝的连接数
+    bool mInlineRequest = false;               // 事件循环正在直接处理高优先级请求 (防止流水线请求递归)
+    std::unique_ptr<LatencyStats> mLatency;
+    std::unique_ptr<RateLimiter> mRateLimiter; // 未启用限流时为空
+    
+    // SSE 事件缓冲区与订阅者 (订阅者集合仅事件循环线程访问)
+    std::unique_ptr<EventStream> mEvents;
+    std::unordered_set<net::Socket> mEventSubscribers;
+    uint64_t mLastFanoutId = 0;
     
-    // 路由表
-    std::map<std::string, RouteHandler> mGetRoutes;
-    std::map<std::string, RouteHandler> mPostRoutes;
-    std::mutex mRoutesMutex;
+    // WebSocket 连接 (仅事件循环线程访问) 与跨线程的变更通知
+    std::unordered_set<net::Socket> mWebSockets;
+    std::atomic<bool> mWebSocketsDirty{false};
 };
 
 } // namespace serverinfo_rest
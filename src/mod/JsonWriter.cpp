@@ -0,0 +1,52 @@
+#include "mod/JsonWriter.h"
+#include "mod/Utf8.h"
+
+namespace serverinfo_rest {
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    out.reserve(out.size() + value.size() + 2);
+    out += '"';
+    // 按段复制不需要转义的字符，玩家名、xuid 之类的字符串通常一次就复制完
+    // 不合法的 UTF-8 序列替换为 \ufffd (与 nlohmann::json 的 error_handler_t::replace 相同)，输出始终是合法的 JSON
+    size_t runStart = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x80) {
+            size_t length = utf8SequenceLength(value, i);
+            if (length > 0) {
+                i += length - 1;
+                continue;
+            }
+            out.append(value.data() + runStart, i - runStart);
+            out += "\\ufffd";
+            i += utf8InvalidLength(value, i) - 1;
+            runStart = i + 1;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(value.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += kHex[c >> 4];
+            out += kHex[c & 0xF];
+            break;
+        }
+    }
+    out.append(value.data() + runStart, value.size() - runStart);
+    out += '"';
+}
+
+} // namespace serverinfo_rest
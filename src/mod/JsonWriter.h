@@ -0,0 +1,222 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace serverinfo_rest {
+
+// 把字符串按 JSON 规则转义后追加到 out (包括两侧的引号)；不合法的 UTF-8 序列替换为 \ufffd
+void appendJsonString(std::string& out, std::string_view value);
+
+// 类型对应的 JSON 结构，特化后 JsonWriter::value() 可以直接写出该类型 (见 JsonSchema)
+template <typename T>
+struct JsonSchemaOf;
+
+template <typename T>
+concept HasJsonSchema = requires { typename JsonSchemaOf<T>::type; };
+
+// 直接写入字符串缓冲区的 JSON 生成器，不构建中间 DOM
+// 逗号自动插入；对象中必须先写 key() 再写 value()
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : mOut(out) {}
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    JsonWriter& key(std::string_view name) {
+        separate();
+        appendJsonString(mOut, name);
+        mOut += ':';
+        mAfterKey = true;
+        return *this;
+    }
+
+    // 已经带引号和冒号的 key (由 JsonKey 在编译期生成)
+    JsonWriter& rawKey(std::string_view quotedKey) {
+        separate();
+        mOut += quotedKey;
+        mAfterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view text) {
+        separate();
+        appendJsonString(mOut, text);
+        return *this;
+    }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+
+    JsonWriter& value(bool flag) {
+        separate();
+        mOut += flag ? "true" : "false";
+        return *this;
+    }
+
+    JsonWriter& value(std::nullptr_t) {
+        separate();
+        mOut += "null";
+        return *this;
+    }
+
+    template <typename T>
+        requires(std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>)
+    JsonWriter& value(T number) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        separate();
+        mOut.append(buffer, result.ptr);
+        return *this;
+    }
+
+    // 最短的可往返表示；NaN 和无穷大不是合法的 JSON 数字，写为 null
+    template <std::floating_point T>
+    JsonWriter& value(T number) {
+        if (number != number || number - number != 0) {
+            return value(nullptr);
+        }
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        separate();
+        mOut.append(buffer, result.ptr);
+        return *this;
+    }
+
+    // 指针和智能指针写出其指向的对象，空指针写为 null
+    template <typename T>
+    JsonWriter& value(const T* pointer) {
+        return pointer ? value(*pointer) : value(nullptr);
+    }
+    template <typename T>
+    JsonWriter& value(const std::shared_ptr<T>& pointer) {
+        return pointer ? value(*pointer) : value(nullptr);
+    }
+
+    // 有 JsonSchemaOf 特化的类型写为对象
+    template <HasJsonSchema T>
+    JsonWriter& value(const T& object) {
+        JsonSchemaOf<T>::type::write(*this, object);
+        return *this;
+    }
+
+    // 其他范围写为数组
+    template <std::ranges::input_range R>
+        requires(!std::convertible_to<const R&, std::string_view> && !HasJsonSchema<R>)
+    JsonWriter& value(const R& range) {
+        beginArray();
+        for (const auto& element : range) {
+            value(element);
+        }
+        return endArray();
+    }
+
+    // 已经序列化好的 JSON 片段
+    JsonWriter& rawValue(std::string_view json) {
+        separate();
+        mOut += json;
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& fieldValue) {
+        key(name);
+        return value(fieldValue);
+    }
+
+private:
+    void separate() {
+        if (mAfterKey) {
+            mAfterKey = false;
+        } else if (mNeedComma) {
+            mOut += ',';
+        }
+        mNeedComma = true;
+    }
+
+    JsonWriter& open(char bracket) {
+        separate();
+        mOut += bracket;
+        mNeedComma = false;
+        return *this;
+    }
+
+    JsonWriter& close(char bracket) {
+        mOut += bracket;
+        mNeedComma = true;
+        return *this;
+    }
+
+    std::string& mOut;
+    bool mNeedComma = false;
+    bool mAfterKey = false;
+};
+
+// 编译期生成的 "name": 前缀，名字中不允许出现需要转义的字符
+template <size_t N>
+struct JsonKey {
+    char text[N + 2]{};
+
+    consteval JsonKey(const char (&name)[N]) {
+        text[0] = '"';
+        for (size_t i = 0; i + 1 < N; ++i) {
+            char c = name[i];
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                throw "JSON key must not need escaping";
+            }
+            text[i + 1] = c;
+        }
+        text[N] = '"';
+        text[N + 1] = ':';
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const { return {text, N + 2}; }
+};
+
+// 一个字段：名字 + 成员指针
+template <JsonKey Key, auto Member>
+struct JsonField {
+    template <typename T>
+    static void write(JsonWriter& writer, const T& object) {
+        writer.rawKey(Key.view());
+        writer.value(object.*Member);
+    }
+};
+
+// 对象的字段表，展开后每个字段就是一次 key 拷贝加一次 value 写入
+// 例如 using PlayerJson = JsonSchema<JsonField<"name", &Player::name>, JsonField<"xuid", &Player::xuid>>;
+template <typename... Fields>
+struct JsonSchema {
+    template <typename T>
+    static void write(JsonWriter& writer, const T& object) {
+        writer.beginObject();
+        writeFields(writer, object);
+        writer.endObject();
+    }
+
+    // 只写字段，用于在同一个对象中追加其他字段
+    template <typename T>
+    static void writeFields(JsonWriter& writer, const T& object) {
+        (Fields::write(writer, object), ...);
+    }
+};
+
+// 用指定的字段表把对象序列化为字符串
+template <typename Schema, typename T>
+std::string toJson(const T& object, size_t reserve = 256) {
+    std::string out;
+    out.reserve(reserve);
+    JsonWriter writer(out);
+    Schema::write(writer, object);
+    return out;
+}
+
+} // namespace serverinfo_rest
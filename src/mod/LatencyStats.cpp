@@ -0,0 +1,156 @@
+#include "mod/LatencyStats.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace serverinfo_rest {
+
+const char* latencyPhaseName(LatencyPhase phase) {
+    switch (phase) {
+    case LatencyPhase::Receive: return "receive";
+    case LatencyPhase::Parse: return "parse";
+    case LatencyPhase::Queue: return "queue";
+    case LatencyPhase::Handler: return "handler";
+    case LatencyPhase::Serialize: return "serialize";
+    case LatencyPhase::Wakeup: return "wakeup";
+    case LatencyPhase::Send: return "send";
+    case LatencyPhase::Total: return "total";
+    case LatencyPhase::Count_: break;
+    }
+    return "unknown";
+}
+
+// ==================== HistogramSnapshot ====================
+
+size_t HistogramSnapshot::bucketOf(uint64_t value) {
+    // 小于 8 的值每个值一个桶；之后每个 2 的幂区间分为 8 个桶
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    int exponent = std::bit_width(value) - 1;
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    size_t sub = static_cast<size_t>(value >> (exponent - kSubBucketBits)) - kSubBuckets;
+    return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t HistogramSnapshot::bucketUpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    int exponent = static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    uint64_t sub = bucket % kSubBuckets;
+    uint64_t width = uint64_t(1) << (exponent - kSubBucketBits);
+    return ((kSubBuckets + sub) << (exponent - kSubBucketBits)) + width - 1;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    // 各个计数器是分别读取的，桶计数之和可能与 count 略有出入，以桶计数为准
+    uint64_t total = 0;
+    for (auto c : counts) total += c;
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            return std::min(bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+// ==================== LatencyHistogram ====================
+
+void LatencyHistogram::record(uint64_t value) {
+    bump(mCounts[HistogramSnapshot::bucketOf(value)], 1);
+    bump(mCount, 1);
+    bump(mSum, value);
+    if (value > mMax.load(std::memory_order_relaxed)) {
+        mMax.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::snapshotInto(HistogramSnapshot& out) const {
+    for (size_t i = 0; i < HistogramSnapshot::kBucketCount; ++i) {
+        out.counts[i] += mCounts[i].load(std::memory_order_relaxed);
+    }
+    out.count += mCount.load(std::memory_order_relaxed);
+    out.sum += mSum.load(std::memory_order_relaxed);
+    out.max = std::max(out.max, mMax.load(std::memory_order_relaxed));
+}
+
+// ==================== LatencyStats ====================
+
+static std::atomic<uint64_t> gNextStatsInstance{1};
+
+LatencyStats::LatencyStats(size_t routeSlots)
+    : mInstanceId(gNextStatsInstance.fetch_add(1)), mRouteSlots(routeSlots) {}
+
+LatencyStats::ThreadHistograms& LatencyStats::local() {
+    // 每个线程缓存最近使用的实例；服务器重启后实例 ID 变化，会重新注册
+    thread_local uint64_t cachedInstance = 0;
+    thread_local ThreadHistograms* cached = nullptr;
+    if (cachedInstance == mInstanceId) {
+        return *cached;
+    }
+
+    auto histograms = std::make_unique<ThreadHistograms>();
+    histograms->routeHandler = std::make_unique<LatencyHistogram[]>(mRouteSlots);
+    histograms->routeTotal = std::make_unique<LatencyHistogram[]>(mRouteSlots);
+    cached = histograms.get();
+    cachedInstance = mInstanceId;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mThreads.push_back(std::move(histograms));
+    return *cached;
+}
+
+void LatencyStats::record(LatencyPhase phase, uint64_t micros) {
+    local().phases[static_cast<size_t>(phase)].record(micros);
+}
+
+void LatencyStats::recordRouteHandler(size_t routeSlot, uint64_t micros) {
+    if (routeSlot < mRouteSlots) {
+        local().routeHandler[routeSlot].record(micros);
+    }
+}
+
+void LatencyStats::recordRouteTotal(size_t routeSlot, uint64_t micros) {
+    if (routeSlot < mRouteSlots) {
+        local().routeTotal[routeSlot].record(micros);
+    }
+}
+
+LatencyStats::Snapshot LatencyStats::snapshot() const {
+    Snapshot snapshot;
+    snapshot.routeHandler.resize(mRouteSlots);
+    snapshot.routeTotal.resize(mRouteSlots);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& thread : mThreads) {
+        for (size_t i = 0; i < snapshot.phases.size(); ++i) {
+            thread->phases[i].snapshotInto(snapshot.phases[i]);
+        }
+        for (size_t i = 0; i < mRouteSlots; ++i) {
+            thread->routeHandler[i].snapshotInto(snapshot.routeHandler[i]);
+            thread->routeTotal[i].snapshotInto(snapshot.routeTotal[i]);
+        }
+    }
+    snapshot.threads = mThreads.size();
+    return snapshot;
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 请求处理的各个阶段
+enum class LatencyPhase {
+    Receive,   // 收到请求的第一个字节 -> 请求完整
+    Parse,     // 完成解析的那次 parse() 调用
+    Queue,     // 交给线程池 -> 工作线程开始处理
+    Handler,   // 路由查找 + handler
+    Serialize, // 构建响应报文
+    Wakeup,    // 工作线程完成 -> 事件循环取到结果
+    Send,      // 事件循环取到结果 -> 响应全部写入 socket
+    Total,     // 收到第一个字节 -> 响应全部写入 socket
+    Count_
+};
+
+const char* latencyPhaseName(LatencyPhase phase);
+
+// 直方图快照，可以合并 (多个线程、多个时间段)
+struct HistogramSnapshot {
+    // 对数-线性分桶：每个 2 的幂区间再均分为 8 个子桶，相对误差不超过 12.5%
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr int kMaxExponent = 40; // 约 12.7 天 (微秒)，更大的值计入最后一个桶
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    std::array<uint64_t, kBucketCount> counts{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void merge(const HistogramSnapshot& other);
+
+    // q 取 0~1，返回该分位所在桶的上界 (不超过 max)
+    [[nodiscard]] uint64_t percentile(double q) const;
+    [[nodiscard]] double mean() const { return count ? static_cast<double>(sum) / count : 0; }
+
+    static size_t bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(size_t bucket);
+};
+
+// 单写者直方图：只由所属线程写入，其他线程可以随时读取 (数值上是近似一致的快照)
+class LatencyHistogram {
+public:
+    void record(uint64_t value);
+    void snapshotInto(HistogramSnapshot& out) const;
+
+private:
+    // 只有一个写者，用 load + store 代替原子加法，避免锁前缀指令
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::kBucketCount> mCounts{};
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<uint64_t> mSum{0};
+    std::atomic<uint64_t> mMax{0};
+};
+
+// 按阶段和路由统计的延迟 (微秒)
+// 每个线程第一次记录时分配自己的一组直方图，之后的记录不加锁也不与其他线程共享缓存行；
+// 只有 snapshot() 时才遍历所有线程的数据并合并。
+class LatencyStats {
+public:
+    explicit LatencyStats(size_t routeSlots);
+
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    void record(LatencyPhase phase, uint64_t micros);
+    // 按路由记录 handler 耗时和总耗时，routeSlot 为路由 ID (最后一个槽位表示未匹配)
+    void recordRouteHandler(size_t routeSlot, uint64_t micros);
+    void recordRouteTotal(size_t routeSlot, uint64_t micros);
+
+    struct Snapshot {
+        std::array<HistogramSnapshot, static_cast<size_t>(LatencyPhase::Count_)> phases;
+        std::vector<HistogramSnapshot> routeHandler;
+        std::vector<HistogramSnapshot> routeTotal;
+        size_t threads = 0;
+    };
+    [[nodiscard]] Snapshot snapshot() const;
+
+private:
+    struct ThreadHistograms {
+        std::array<LatencyHistogram, static_cast<size_t>(LatencyPhase::Count_)> phases;
+        std::unique_ptr<LatencyHistogram[]> routeHandler;
+        std::unique_ptr<LatencyHistogram[]> routeTotal;
+    };
+    ThreadHistograms& local();
+
+    const uint64_t mInstanceId; // 区分先后创建的实例，避免线程缓存指向已销毁的实例
+    const size_t mRouteSlots;
+    mutable std::mutex mMutex;  // 只保护 mThreads 的注册和遍历
+    std::vector<std::unique_ptr<ThreadHistograms>> mThreads;
+};
+
+} // namespace serverinfo_rest
@@ -0,0 +1,163 @@
+#include "mod/Log.h"
+
+namespace serverinfo_rest {
+
+// ==================== AsyncLogSink ====================
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+AsyncLogSink::AsyncLogSink(size_t capacity)
+: mMask(roundUpToPowerOfTwo(capacity) - 1),
+  mSlots(std::make_unique<Slot[]>(mMask + 1)) {
+    for (size_t i = 0; i <= mMask; ++i) {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mThread = std::thread([this] { run(); });
+}
+
+AsyncLogSink::~AsyncLogSink() {
+    mStopping.store(true);
+    mSignal.fetch_add(1);
+    mSignal.notify_one();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+bool AsyncLogSink::push(ll::io::Logger& logger, ll::io::LogLevel level, std::string message) {
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &mSlots[pos & mMask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占写入位置
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // 队列已满
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record.logger = &logger;
+    slot->record.level = level;
+    slot->record.message = std::move(message);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // 与 run() 中的 fence 配对：要么后台线程看到这条消息，要么这里看到它在等待
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mSleeping.load(std::memory_order_relaxed)) {
+        mSignal.fetch_add(1, std::memory_order_release);
+        mSignal.notify_one();
+    }
+    return true;
+}
+
+bool AsyncLogSink::pop(Record& out) {
+    size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &mSlots[pos & mMask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // 队列为空
+        } else {
+            pos = mDequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    out = std::move(slot->record);
+    slot->record.message.clear();
+    slot->sequence.store(pos + mMask + 1, std::memory_order_release);
+    return true;
+}
+
+void AsyncLogSink::run() {
+    Record record;
+    uint64_t reportedDrops = 0;
+    while (true) {
+        while (pop(record)) {
+            logging::print(*record.logger, record.level, record.message);
+        }
+
+        // 报告队列满时丢弃的消息数
+        uint64_t drops = mDropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops && record.logger) {
+            record.logger->warn("{} log messages dropped (async log queue full)", drops - reportedDrops);
+            reportedDrops = drops;
+        }
+
+        if (mStopping.load()) {
+            // 停止前输出剩余的消息
+            while (pop(record)) {
+                logging::print(*record.logger, record.level, record.message);
+            }
+            return;
+        }
+
+        uint32_t signal = mSignal.load(std::memory_order_acquire);
+        mSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 声明等待之后再检查一次，避免错过在此期间写入的消息
+        size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+        bool empty = mSlots[pos & mMask].sequence.load(std::memory_order_acquire) != pos + 1;
+        if (empty && !mStopping.load()) {
+            mSignal.wait(signal, std::memory_order_acquire);
+        }
+        mSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+// ==================== 全局日志输出 ====================
+
+namespace logging {
+
+namespace {
+std::unique_ptr<AsyncLogSink> gAsyncSink;
+}
+
+void startAsync(size_t capacity) {
+    if (gAsyncSink) {
+        return;
+    }
+    gAsyncSink = std::make_unique<AsyncLogSink>(capacity);
+    gSink.store(gAsyncSink.get(), std::memory_order_release);
+}
+
+void stopAsync() {
+    gSink.store(nullptr, std::memory_order_release);
+    gAsyncSink.reset(); // 析构时输出队列中剩余的消息
+}
+
+void print(ll::io::Logger& logger, ll::io::LogLevel level, const std::string& message) {
+    switch (level) {
+    case ll::io::LogLevel::Trace: logger.trace("{}", message); break;
+    case ll::io::LogLevel::Debug: logger.debug("{}", message); break;
+    case ll::io::LogLevel::Info: logger.info("{}", message); break;
+    case ll::io::LogLevel::Warn: logger.warn("{}", message); break;
+    case ll::io::LogLevel::Error: logger.error("{}", message); break;
+    case ll::io::LogLevel::Fatal: logger.fatal("{}", message); break;
+    default: break;
+    }
+}
+
+} // namespace logging
+
+} // namespace serverinfo_rest
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ll/api/io/LogLevel.h"
+#include "ll/api/io/Logger.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+// 编译期最低日志级别，数值与 ll::io::LogLevel 相同: 0 fatal, 1 error, 2 warn, 3 info, 4 debug, 5 trace
+// 高于该级别的 LOG_* 调用在编译期被整体去掉，参数不会被求值；由 xmake 的 log_level 选项设置
+#ifndef SERVERINFO_LOG_LEVEL
+#define SERVERINFO_LOG_LEVEL 5
+#endif
+
+// 用法与 logger.info(...) 相同: LOG_INFO(logger, "Player {} joined", name)
+// 运行期级别 (配置中的 logLevel) 也在求值参数之前检查
+#define SERVERINFO_LOG(logger, level, ...)                                                                             \
+    do {                                                                                                               \
+        if constexpr (static_cast<int>(level) <= SERVERINFO_LOG_LEVEL) {                                               \
+            if (::serverinfo_rest::logging::enabled(level)) {                                                          \
+                ::serverinfo_rest::logging::write((logger), (level), __VA_ARGS__);                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
+
+#define LOG_TRACE(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Error, __VA_ARGS__)
+#define LOG_FATAL(logger, ...) SERVERINFO_LOG(logger, ::ll::io::LogLevel::Fatal, __VA_ARGS__)
+
+namespace serverinfo_rest {
+
+// 异步日志输出：调用线程只格式化消息并写入无锁环形队列，由后台线程交给 logger 输出
+// 队列满时丢弃新消息并计数，调用线程永远不会等待
+class AsyncLogSink {
+public:
+    explicit AsyncLogSink(size_t capacity);
+    ~AsyncLogSink();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    // 返回 false 表示队列已满，消息被丢弃
+    bool push(ll::io::Logger& logger, ll::io::LogLevel level, std::string message);
+
+    [[nodiscard]] uint64_t dropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Record {
+        ll::io::Logger* logger = nullptr;
+        ll::io::LogLevel level = ll::io::LogLevel::Info;
+        std::string message;
+    };
+
+    // Vyukov 有界多生产者多消费者队列的一个槽位，sequence 表示槽位当前可写/可读的轮次
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence{0};
+        Record record;
+    };
+
+    bool pop(Record& out);
+    void run();
+
+    const size_t mMask;
+    std::unique_ptr<Slot[]> mSlots;
+    alignas(64) std::atomic<size_t> mEnqueuePos{0};
+    alignas(64) std::atomic<size_t> mDequeuePos{0};
+
+    std::atomic<uint64_t> mDropped{0};
+    std::atomic<bool> mSleeping{false}; // 后台线程是否在等待，生产者只在此时唤醒它
+    std::atomic<uint32_t> mSignal{0};
+    std::atomic<bool> mStopping{false};
+    std::thread mThread;
+};
+
+namespace logging {
+
+inline std::atomic<int> gLevel{static_cast<int>(ll::io::LogLevel::Info)};
+inline std::atomic<AsyncLogSink*> gSink{nullptr};
+
+// 运行期级别，与 logger.setLevel() 同时设置
+inline void setLevel(ll::io::LogLevel level) { gLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+inline bool enabled(ll::io::LogLevel level) {
+    return static_cast<int>(level) <= gLevel.load(std::memory_order_relaxed);
+}
+
+// 启用/停用异步输出，停用时先输出队列中剩余的消息
+// stopAsync() 必须在其他可能写日志的线程都停止之后调用
+void startAsync(size_t capacity);
+void stopAsync();
+
+// 同步输出到 logger
+void print(ll::io::Logger& logger, ll::io::LogLevel level, const std::string& message);
+
+template <typename... Args>
+void write(ll::io::Logger& logger, ll::io::LogLevel level, fmt::format_string<Args...> format, Args&&... args) {
+    if (AsyncLogSink* sink = gSink.load(std::memory_order_acquire)) {
+        sink->push(logger, level, fmt::format(format, std::forward<Args>(args)...));
+        return;
+    }
+    switch (level) {
+    case ll::io::LogLevel::Trace: logger.trace(format, std::forward<Args>(args)...); break;
+    case ll::io::LogLevel::Debug: logger.debug(format, std::forward<Args>(args)...); break;
+    case ll::io::LogLevel::Info: logger.info(format, std::forward<Args>(args)...); break;
+    case ll::io::LogLevel::Warn: logger.warn(format, std::forward<Args>(args)...); break;
+    case ll::io::LogLevel::Error: logger.error(format, std::forward<Args>(args)...); break;
+    case ll::io::LogLevel::Fatal: logger.fatal(format, std::forward<Args>(args)...); break;
+    default: break;
+    }
+}
+
+} // namespace logging
+
+} // namespace serverinfo_rest
@@ -0,0 +1,114 @@
+#include "mod/PlayerCache.h"
+
+#include <algorithm>
+
+namespace serverinfo_rest {
+
+static bool lessByXuid(const std::shared_ptr<const CachedPlayerInfo>& player, std::string_view xuid) {
+    return player->xuid < xuid;
+}
+
+const CachedPlayerInfo* PlayerSnapshot::findByXuid(std::string_view xuid) const {
+    auto it = std::lower_bound(players.begin(), players.end(), xuid, lessByXuid);
+    return (it != players.end() && (*it)->xuid == xuid) ? it->get() : nullptr;
+}
+
+std::string foldName(std::string_view name) {
+    std::string folded(name);
+    for (auto& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return folded;
+}
+
+const CachedPlayerInfo* PlayerSnapshot::findByName(std::string_view name) const {
+    auto it = byName.find(name);
+    return it != byName.end() ? players[it->second].get() : nullptr;
+}
+
+const CachedPlayerInfo* PlayerSnapshot::findByNameIgnoreCase(std::string_view name) const {
+    std::string folded = foldName(name);
+    auto it = std::lower_bound(byFoldedName.begin(), byFoldedName.end(), folded,
+                               [](const auto& entry, const std::string& key) { return entry.first < key; });
+    return (it != byFoldedName.end() && it->first == folded) ? players[it->second].get() : nullptr;
+}
+
+std::vector<const CachedPlayerInfo*> PlayerSnapshot::searchByPrefix(std::string_view prefix, size_t limit) const {
+    std::vector<const CachedPlayerInfo*> result;
+    std::string folded = foldName(prefix);
+    auto it = std::lower_bound(byFoldedName.begin(), byFoldedName.end(), folded,
+                               [](const auto& entry, const std::string& key) { return entry.first < key; });
+    for (; it != byFoldedName.end() && result.size() < limit; ++it) {
+        if (it->first.compare(0, folded.size(), folded) != 0) {
+            break;
+        }
+        result.push_back(players[it->second].get());
+    }
+    return result;
+}
+
+void PlayerSnapshot::buildIndexes() {
+    byName.clear();
+    byName.reserve(players.size());
+    byFoldedName.clear();
+    byFoldedName.reserve(players.size());
+
+    for (uint32_t i = 0; i < players.size(); ++i) {
+        byName.emplace(players[i]->name, i);
+        byFoldedName.emplace_back(foldName(players[i]->name), i);
+    }
+    std::sort(byFoldedName.begin(), byFoldedName.end());
+}
+
+PlayerCache::PlayerCache() : mCurrent(std::make_shared<const PlayerSnapshot>()) {}
+
+void PlayerCache::upsert(CachedPlayerInfo info) {
+    auto entry = std::make_shared<const CachedPlayerInfo>(std::move(info));
+
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    auto current = mCurrent.load(std::memory_order_acquire);
+    auto next = std::make_shared<PlayerSnapshot>();
+    next->players = current->players;
+
+    auto it = std::lower_bound(next->players.begin(), next->players.end(), entry->xuid, lessByXuid);
+    if (it != next->players.end() && (*it)->xuid == entry->xuid) {
+        *it = std::move(entry);
+    } else {
+        next->players.insert(it, std::move(entry));
+    }
+    publish(std::move(next));
+}
+
+std::shared_ptr<const CachedPlayerInfo> PlayerCache::remove(std::string_view xuid) {
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    auto current = mCurrent.load(std::memory_order_acquire);
+
+    auto it = std::lower_bound(current->players.begin(), current->players.end(), xuid, lessByXuid);
+    if (it == current->players.end() || (*it)->xuid != xuid) {
+        return nullptr;
+    }
+    auto removed = *it;
+
+    auto next = std::make_shared<PlayerSnapshot>();
+    next->players = current->players;
+    next->players.erase(next->players.begin() + (it - current->players.begin()));
+    publish(std::move(next));
+    return removed;
+}
+
+size_t PlayerCache::clear() {
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    size_t count = mCurrent.load(std::memory_order_acquire)->players.size();
+    publish(std::make_shared<PlayerSnapshot>());
+    return count;
+}
+
+void PlayerCache::publish(std::shared_ptr<PlayerSnapshot> next) {
+    uint64_t generation = mGeneration.load(std::memory_order_relaxed) + 1;
+    next->generation = generation;
+    next->buildIndexes();
+    mCurrent.store(std::move(next), std::memory_order_release);
+    mGeneration.store(generation, std::memory_order_release);
+}
+
+} // namespace serverinfo_rest
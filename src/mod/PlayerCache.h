@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 缓存的玩家信息结构
+struct CachedPlayerInfo {
+    std::string name;
+    std::string xuid;
+    std::string uuid;
+    std::string ipAndPort;
+    std::string locale;
+    bool isOperator = false;
+    float posX = 0, posY = 0, posZ = 0;
+};
+
+// 名字大小写折叠 (玩家名只包含 ASCII 字符)
+std::string foldName(std::string_view name);
+
+// 玩家缓存在某一时刻的不可变快照
+// 发布后不会再被修改，读者持有 shared_ptr 期间可以无锁访问其中的任何数据
+struct PlayerSnapshot {
+    uint64_t generation = 0;
+    std::vector<std::shared_ptr<const CachedPlayerInfo>> players; // 按 xuid 排序
+
+    // 二级索引，发布前由 buildIndexes() 生成，值为 players 中的下标
+    std::unordered_map<std::string_view, uint32_t> byName;      // 精确名字 (视图指向 players 中的字符串)
+    std::vector<std::pair<std::string, uint32_t>> byFoldedName; // 折叠后的名字，有序，用于忽略大小写查找和前缀搜索
+
+    [[nodiscard]] size_t size() const { return players.size(); }
+
+    const CachedPlayerInfo* findByXuid(std::string_view xuid) const;      // O(log n)
+    const CachedPlayerInfo* findByName(std::string_view name) const;      // O(1)
+    const CachedPlayerInfo* findByNameIgnoreCase(std::string_view name) const; // O(log n)
+
+    // 忽略大小写的前缀搜索，结果按名字排序，最多返回 limit 个
+    std::vector<const CachedPlayerInfo*> searchByPrefix(std::string_view prefix, size_t limit) const;
+
+    void buildIndexes();
+};
+
+// 读多写少的玩家缓存 (RCU 风格)
+// 写入方 (游戏线程的事件回调) 复制当前快照、修改后原子地发布新快照；
+// 读者 (HTTP 线程) 只做一次原子 load 拿到快照，不加锁也不复制玩家数据。
+// 修改时只复制 shared_ptr 数组，未变化的玩家信息在新旧快照间共享。
+class PlayerCache {
+public:
+    PlayerCache();
+
+    // 读者：获取当前快照
+    [[nodiscard]] std::shared_ptr<const PlayerSnapshot> snapshot() const {
+        return mCurrent.load(std::memory_order_acquire);
+    }
+
+    // 当前快照的版本号 (在快照发布之后才递增，读到的值不会比随后取得的快照更新)
+    [[nodiscard]] uint64_t generation() const { return mGeneration.load(std::memory_order_acquire); }
+
+    // 写入方：插入或更新玩家 (按 xuid)
+    void upsert(CachedPlayerInfo info);
+    // 写入方：移除玩家，返回被移除的玩家信息 (不存在时为空)
+    std::shared_ptr<const CachedPlayerInfo> remove(std::string_view xuid);
+    // 写入方：清空缓存，返回清除前的玩家数量
+    size_t clear();
+
+private:
+    void publish(std::shared_ptr<PlayerSnapshot> next);
+
+    std::mutex mWriteMutex; // 只在写入方之间互斥，读者从不获取
+    std::atomic<std::shared_ptr<const PlayerSnapshot>> mCurrent;
+    std::atomic<uint64_t> mGeneration{0};
+};
+
+} // namespace serverinfo_rest
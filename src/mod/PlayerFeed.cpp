@@ -0,0 +1,289 @@
+#include "mod/PlayerFeed.h"
+#include "mod/HttpServer.h"
+#include "mod/ServerInfoRestMod.h"
+
+#include <nlohmann/json.hpp>
+
+namespace serverinfo_rest {
+
+namespace {
+
+// 未确认的增量最多保留的条数，超过后丢弃最旧的 (客户端再确认它们时忽略)
+constexpr size_t kMaxUnacked = 32;
+
+constexpr std::pair<PlayerFeedTopic, const char*> kTopicNames[] = {
+    {TopicPlayers, "players"},
+    {TopicPositions, "positions"},
+    {TopicStatus, "status"},
+};
+
+uint32_t parseTopic(std::string_view name) {
+    for (const auto& [topic, topicName] : kTopicNames) {
+        if (name == topicName) return topic;
+    }
+    return 0;
+}
+
+nlohmann::json topicList(uint32_t topics) {
+    auto list = nlohmann::json::array();
+    for (const auto& [topic, topicName] : kTopicNames) {
+        if (topics & topic) list.push_back(topicName);
+    }
+    return list;
+}
+
+void sendError(std::vector<std::string>& out, std::string_view error) {
+    nlohmann::json json;
+    json["op"] = "error";
+    json["error"] = error;
+    out.push_back(json.dump());
+}
+
+nlohmann::json playerJson(const CachedPlayerInfo& player) {
+    nlohmann::json json;
+    json["name"] = player.name;
+    json["xuid"] = player.xuid;
+    json["uuid"] = player.uuid;
+    json["isOperator"] = player.isOperator;
+    return json;
+}
+
+// 名单相关的字段是否相同 (坐标变化不算名单变化)
+bool sameRosterEntry(const CachedPlayerInfo& a, const CachedPlayerInfo& b) {
+    return &a == &b || (a.name == b.name && a.uuid == b.uuid && a.isOperator == b.isOperator);
+}
+
+// 按 key 归并两个有序列表，分别回调新增/变化的元素和被移除的元素
+template <typename T, typename KeyFn, typename SameFn, typename UpsertFn, typename RemoveFn>
+void diffSorted(const std::vector<T>& from, const std::vector<T>& to, KeyFn key, SameFn same, UpsertFn onUpsert,
+                RemoveFn onRemove) {
+    size_t i = 0, j = 0;
+    while (i < from.size() || j < to.size()) {
+        if (j == to.size() || (i < from.size() && key(from[i]) < key(to[j]))) {
+            onRemove(from[i++]);
+        } else if (i == from.size() || key(to[j]) < key(from[i])) {
+            onUpsert(to[j++]);
+        } else {
+            if (!same(from[i], to[j])) onUpsert(to[j]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+} // namespace
+
+void PlayerFeedSession::onOpen(std::vector<std::string>& out) {
+    nlohmann::json json;
+    json["op"] = "hello";
+    json["topics"] = topicList(TopicPlayers | TopicPositions | TopicStatus);
+    out.push_back(json.dump());
+}
+
+void PlayerFeedSession::onMessage(std::string_view text, std::vector<std::string>& out) {
+    auto message = nlohmann::json::parse(text, nullptr, false);
+    if (message.is_discarded() || !message.is_object()) {
+        sendError(out, "Invalid JSON message");
+        return;
+    }
+
+    std::string op = message.value("op", "");
+    if (op == "ack") {
+        auto seq = message.find("seq");
+        if (seq == message.end() || !seq->is_number_unsigned()) {
+            sendError(out, "Missing seq");
+            return;
+        }
+        acknowledge(seq->get<uint64_t>());
+        return;
+    }
+
+    if (op == "subscribe" || op == "unsubscribe") {
+        // topics 可以是字符串或字符串数组
+        uint32_t topics = 0;
+        auto names = message.value("topics", nlohmann::json());
+        if (names.is_string()) names = nlohmann::json::array({names});
+        for (const auto& name : names) {
+            uint32_t topic = name.is_string() ? parseTopic(name.get<std::string>()) : 0;
+            if (topic == 0) {
+                sendError(out, "Unknown topic: " + name.dump());
+                return;
+            }
+            topics |= topic;
+        }
+
+        if (op == "subscribe") {
+            resetTopics(topics & ~mTopics);
+            mTopics |= topics;
+        } else {
+            mTopics &= ~topics;
+            resetTopics(topics);
+        }
+
+        nlohmann::json reply;
+        reply["op"] = "subscribed";
+        reply["topics"] = topicList(mTopics);
+        out.push_back(reply.dump());
+
+        // 新订阅的主题立即推送一次全量
+        if (op == "subscribe") {
+            mForcePoll = true;
+            onPoll(out);
+        }
+        return;
+    }
+
+    sendError(out, "Unknown op: " + op);
+}
+
+void PlayerFeedSession::onPoll(std::vector<std::string>& out) {
+    if (mTopics == 0) {
+        return;
+    }
+    // 只订阅了名单/状态时，采样变化与本会话无关
+    bool samplesChanged = (mTopics & TopicPositions) && mMod.getPlayerSampleSequence() != mLastSampleSequence;
+    if (!mForcePoll && !samplesChanged && mMod.getPlayerCacheGeneration() == mLastGeneration) {
+        return;
+    }
+
+    FeedState current = captureState();
+    mLastGeneration = current.generation;
+    mLastSampleSequence = current.sampleSequence;
+    mForcePoll = false;
+
+    // 增量以客户端确认过的状态为基准；同时与最后发送的状态比较，避免重复发送相同的增量
+    bool changed = current.topics != mLastSent.topics;
+    nlohmann::json delta;
+
+    if (current.topics & TopicPlayers) {
+        bool reset = !(mAcked.topics & TopicPlayers);
+        static const std::vector<std::shared_ptr<const CachedPlayerInfo>> kEmptyPlayers;
+        const auto& base = reset ? kEmptyPlayers : mAcked.players;
+
+        auto upsert = nlohmann::json::array();
+        auto remove = nlohmann::json::array();
+        auto key = [](const auto& player) -> std::string_view { return player->xuid; };
+        auto same = [](const auto& a, const auto& b) { return sameRosterEntry(*a, *b); };
+        diffSorted(base, current.players, key, same, [&](const auto& player) { upsert.push_back(playerJson(*player)); },
+                   [&](const auto& player) { remove.push_back(player->xuid); });
+        if (reset || !upsert.empty() || !remove.empty()) {
+            auto& topic = delta["players"];
+            if (reset) topic["reset"] = true;
+            topic["upsert"] = std::move(upsert);
+            topic["remove"] = std::move(remove);
+        }
+
+        if (!changed) {
+            diffSorted(mLastSent.players, current.players, key, same, [&](const auto&) { changed = true; },
+                       [&](const auto&) { changed = true; });
+        }
+    }
+
+    if (current.topics & TopicPositions) {
+        bool reset = !(mAcked.topics & TopicPositions);
+        static const std::vector<std::pair<std::string, Position>> kEmptyPositions;
+        const auto& base = reset ? kEmptyPositions : mAcked.positions;
+
+        auto upsert = nlohmann::json::object();
+        auto remove = nlohmann::json::array();
+        auto key = [](const auto& entry) -> std::string_view { return entry.first; };
+        auto same = [](const auto& a, const auto& b) { return a.second == b.second; };
+        diffSorted(base, current.positions, key, same,
+                   [&](const auto& entry) {
+                       const auto& pos = entry.second;
+                       upsert[entry.first] = {pos.x, pos.y, pos.z, pos.dimension};
+                   },
+                   [&](const auto& entry) { remove.push_back(entry.first); });
+        if (reset || !upsert.empty() || !remove.empty()) {
+            auto& topic = delta["positions"];
+            if (reset) topic["reset"] = true;
+            topic["upsert"] = std::move(upsert);
+            topic["remove"] = std::move(remove);
+        }
+
+        if (!changed) {
+            diffSorted(mLastSent.positions, current.positions, key, same, [&](const auto&) { changed = true; },
+                       [&](const auto&) { changed = true; });
+        }
+    }
+
+    if (current.topics & TopicStatus) {
+        if (!(mAcked.topics & TopicStatus) || mAcked.playerCount != current.playerCount) {
+            delta["status"] = {{"playerCount", current.playerCount}, {"status", "running"}};
+        }
+        changed = changed || mLastSent.playerCount != current.playerCount;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    uint64_t seq = mNextSeq++;
+    delta["op"] = "delta";
+    delta["seq"] = seq;
+    out.push_back(delta.dump());
+
+    mLastSent = current;
+    mUnacked.emplace_back(seq, std::move(current));
+    if (mUnacked.size() > kMaxUnacked) {
+        mUnacked.pop_front();
+    }
+}
+
+PlayerFeedSession::FeedState PlayerFeedSession::captureState() const {
+    FeedState state;
+    state.topics = mTopics;
+
+    auto snapshot = mMod.getPlayerSnapshot();
+    state.generation = snapshot->generation;
+    state.playerCount = snapshot->size();
+    if (mTopics & TopicPlayers) {
+        state.players = snapshot->players;
+    }
+    if (mTopics & TopicPositions) {
+        // 采样结果已按 xuid 排序；尚未采样时退回加入时记录的坐标
+        if (auto samples = mMod.getPlayerSamples()) {
+            state.sampleSequence = samples->sequence;
+            state.positions.reserve(samples->players.size());
+            for (const auto& sample : samples->players) {
+                state.positions.emplace_back(sample.xuid,
+                                             Position{sample.posX, sample.posY, sample.posZ, sample.dimension});
+            }
+        } else {
+            state.positions.reserve(snapshot->size());
+            for (const auto& player : snapshot->players) {
+                state.positions.emplace_back(player->xuid, Position{player->posX, player->posY, player->posZ, 0});
+            }
+        }
+    }
+    return state;
+}
+
+// 主题重新订阅或取消订阅时，从所有基准状态中清除它，下次推送该主题的全量
+void PlayerFeedSession::resetTopics(uint32_t topics) {
+    if (topics == 0) {
+        return;
+    }
+    auto clear = [topics](FeedState& state) {
+        state.topics &= ~topics;
+        if (topics & TopicPlayers) state.players.clear();
+        if (topics & TopicPositions) state.positions.clear();
+    };
+    clear(mAcked);
+    clear(mLastSent);
+    for (auto& [seq, state] : mUnacked) {
+        clear(state);
+    }
+}
+
+void PlayerFeedSession::acknowledge(uint64_t seq) {
+    while (!mUnacked.empty() && mUnacked.front().first < seq) {
+        mUnacked.pop_front();
+    }
+    if (!mUnacked.empty() && mUnacked.front().first == seq) {
+        mAcked = std::move(mUnacked.front().second);
+        mUnacked.pop_front();
+    }
+}
+
+} // namespace serverinfo_rest
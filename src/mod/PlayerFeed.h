@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mod/PlayerCache.h"
+#include "mod/WebSocket.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace serverinfo_rest {
+
+class ServerInfoRestMod;
+
+// WebSocket 订阅主题 (位掩码)
+enum PlayerFeedTopic : uint32_t {
+    TopicPlayers = 1 << 0,   // 在线玩家名单
+    TopicPositions = 1 << 1, // 玩家坐标与维度 (来自游戏刻采样)
+    TopicStatus = 1 << 2,    // 服务器状态 (在线人数)
+};
+
+// /ws 上的一个订阅会话
+// 客户端: {"op":"subscribe","topics":[...]} / {"op":"unsubscribe","topics":[...]} / {"op":"ack","seq":n}
+// 服务器: {"op":"delta","seq":n,...}，内容是当前状态相对于客户端最后确认 (ack) 的状态的差异。
+// 客户端没有及时确认时，后续增量仍以最后确认的状态为基准，因此丢掉中间任何一条增量都不会导致状态错乱。
+class PlayerFeedSession : public WebSocketSession {
+public:
+    explicit PlayerFeedSession(const ServerInfoRestMod& mod) : mMod(mod) {}
+
+    void onOpen(std::vector<std::string>& out) override;
+    void onMessage(std::string_view text, std::vector<std::string>& out) override;
+    void onPoll(std::vector<std::string>& out) override;
+
+private:
+    struct Position {
+        float x = 0, y = 0, z = 0;
+        int dimension = 0;
+        bool operator==(const Position&) const = default;
+    };
+
+    // 某一时刻客户端可见的状态，两个列表都按 xuid 排序
+    struct FeedState {
+        std::vector<std::shared_ptr<const CachedPlayerInfo>> players;
+        std::vector<std::pair<std::string, Position>> positions;
+        size_t playerCount = 0;
+        uint64_t generation = 0;
+        uint64_t sampleSequence = 0;
+        uint32_t topics = 0; // 状态中包含的主题，缺少的主题下一条增量发送全量
+    };
+
+    FeedState captureState() const;
+    void resetTopics(uint32_t topics);
+    void acknowledge(uint64_t seq);
+
+    const ServerInfoRestMod& mMod;
+    uint32_t mTopics = 0;
+    uint64_t mNextSeq = 1;
+    uint64_t mLastGeneration = UINT64_MAX; // 上次推送时的数据版本，没有变化时跳过比较
+    uint64_t mLastSampleSequence = UINT64_MAX;
+    bool mForcePoll = false;
+
+    FeedState mAcked;                                 // 客户端最后确认的状态
+    FeedState mLastSent;                              // 最后一条已发送增量之后的状态
+    std::deque<std::pair<uint64_t, FeedState>> mUnacked; // 已发送未确认的增量对应的状态
+};
+
+} // namespace serverinfo_rest
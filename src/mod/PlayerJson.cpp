@@ -0,0 +1,88 @@
+#include "mod/PlayerJson.h"
+
+namespace serverinfo_rest {
+
+namespace {
+
+using FieldWriter = void (*)(JsonWriter&, const CachedPlayerInfo&, const PlayerSample*);
+
+template <typename Field>
+void writeCached(JsonWriter& writer, const CachedPlayerInfo& player, const PlayerSample*) {
+    Field::write(writer, player);
+}
+
+template <typename Field>
+void writeSampled(JsonWriter& writer, const CachedPlayerInfo&, const PlayerSample* sample) {
+    if (sample) Field::write(writer, *sample);
+}
+
+void writePosition(JsonWriter& writer, const CachedPlayerInfo& player, const PlayerSample* sample) {
+    writer.key("position").beginObject();
+    if (sample) {
+        writer.field("x", sample->posX).field("y", sample->posY).field("z", sample->posZ);
+    } else {
+        writer.field("x", player.posX).field("y", player.posY).field("z", player.posZ);
+    }
+    writer.endObject();
+}
+
+struct PlayerFieldInfo {
+    std::string_view name;
+    uint32_t bit;
+    FieldWriter write;
+};
+
+// 输出顺序与表中顺序相同
+constexpr PlayerFieldInfo kPlayerFields[] = {
+    {"name", PlayerFieldName, writeCached<JsonField<"name", &CachedPlayerInfo::name>>},
+    {"xuid", PlayerFieldXuid, writeCached<JsonField<"xuid", &CachedPlayerInfo::xuid>>},
+    {"uuid", PlayerFieldUuid, writeCached<JsonField<"uuid", &CachedPlayerInfo::uuid>>},
+    {"ipAndPort", PlayerFieldIpAndPort, writeCached<JsonField<"ipAndPort", &CachedPlayerInfo::ipAndPort>>},
+    {"locale", PlayerFieldLocale, writeCached<JsonField<"locale", &CachedPlayerInfo::locale>>},
+    {"isOperator", PlayerFieldIsOperator, writeCached<JsonField<"isOperator", &CachedPlayerInfo::isOperator>>},
+    {"position", PlayerFieldPosition, writePosition},
+    {"dimension", PlayerFieldDimension, writeSampled<JsonField<"dimension", &PlayerSample::dimension>>},
+    {"health", PlayerFieldHealth, writeSampled<JsonField<"health", &PlayerSample::health>>},
+    {"maxHealth", PlayerFieldMaxHealth, writeSampled<JsonField<"maxHealth", &PlayerSample::maxHealth>>},
+    {"ping", PlayerFieldPing, writeSampled<JsonField<"ping", &PlayerSample::ping>>},
+};
+
+} // namespace
+
+uint32_t parsePlayerFields(std::string_view list, std::string_view& unknown) {
+    uint32_t fields = 0;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view name = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+        if (name.empty()) continue;
+
+        uint32_t bit = 0;
+        for (const auto& field : kPlayerFields) {
+            if (field.name == name) {
+                bit = field.bit;
+                break;
+            }
+        }
+        if (bit == 0) {
+            unknown = name;
+            return 0;
+        }
+        fields |= bit;
+    }
+    return fields;
+}
+
+std::string_view playerFieldNames() {
+    return "name,xuid,uuid,ipAndPort,locale,isOperator,position,dimension,health,maxHealth,ping";
+}
+
+void writePlayerFields(JsonWriter& writer, const CachedPlayerInfo& player, const PlayerSample* sample, uint32_t fields) {
+    for (const auto& field : kPlayerFields) {
+        if (fields & field.bit) {
+            field.write(writer, player, sample);
+        }
+    }
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "mod/JsonWriter.h"
+#include "mod/PlayerCache.h"
+#include "mod/PlayerSampler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace serverinfo_rest {
+
+// ==================== 玩家 ====================
+
+// 列表、搜索结果和加入事件中的玩家
+using PlayerSummaryJson = JsonSchema<
+    JsonField<"name", &CachedPlayerInfo::name>,
+    JsonField<"xuid", &CachedPlayerInfo::xuid>,
+    JsonField<"uuid", &CachedPlayerInfo::uuid>>;
+
+// 单个玩家详情中来自缓存的字段 (坐标等实时状态由调用方追加)
+using PlayerDetailJson = JsonSchema<
+    JsonField<"name", &CachedPlayerInfo::name>,
+    JsonField<"xuid", &CachedPlayerInfo::xuid>,
+    JsonField<"uuid", &CachedPlayerInfo::uuid>,
+    JsonField<"ipAndPort", &CachedPlayerInfo::ipAndPort>,
+    JsonField<"locale", &CachedPlayerInfo::locale>,
+    JsonField<"isOperator", &CachedPlayerInfo::isOperator>>;
+
+// 离开事件中的玩家
+using PlayerRefJson = JsonSchema<
+    JsonField<"name", &CachedPlayerInfo::name>,
+    JsonField<"xuid", &CachedPlayerInfo::xuid>>;
+
+// 数组中的玩家默认按摘要输出
+template <>
+struct JsonSchemaOf<CachedPlayerInfo> {
+    using type = PlayerSummaryJson;
+};
+
+// ==================== 字段投影 (/players?fields=) ====================
+
+// 可选择输出的玩家字段 (位掩码)
+enum PlayerField : uint32_t {
+    PlayerFieldName = 1 << 0,
+    PlayerFieldXuid = 1 << 1,
+    PlayerFieldUuid = 1 << 2,
+    PlayerFieldIpAndPort = 1 << 3,
+    PlayerFieldLocale = 1 << 4,
+    PlayerFieldIsOperator = 1 << 5,
+    PlayerFieldPosition = 1 << 6,
+    PlayerFieldDimension = 1 << 7,
+    PlayerFieldHealth = 1 << 8,
+    PlayerFieldMaxHealth = 1 << 9,
+    PlayerFieldPing = 1 << 10,
+};
+
+// 与 PlayerSummaryJson 相同的默认字段
+constexpr uint32_t kDefaultPlayerFields = PlayerFieldName | PlayerFieldXuid | PlayerFieldUuid;
+// 需要采样数据的字段
+constexpr uint32_t kSampledPlayerFields =
+    PlayerFieldPosition | PlayerFieldDimension | PlayerFieldHealth | PlayerFieldMaxHealth | PlayerFieldPing;
+
+// 解析逗号分隔的字段名，遇到未知字段时返回 0 并把它写入 unknown
+uint32_t parsePlayerFields(std::string_view list, std::string_view& unknown);
+
+// 逗号分隔的全部字段名，用于错误提示
+std::string_view playerFieldNames();
+
+// 只写出 fields 中选中的字段 (不含外层花括号)；sample 为空时位置退回加入时的坐标，其余采样字段省略
+void writePlayerFields(JsonWriter& writer, const CachedPlayerInfo& player, const PlayerSample* sample, uint32_t fields);
+
+// ==================== 响应外层 ====================
+
+struct StatusEnvelope {
+    std::string_view status;
+    std::string_view plugin;
+    std::string_view version;
+    size_t playerCount = 0;
+};
+using StatusJson = JsonSchema<
+    JsonField<"status", &StatusEnvelope::status>,
+    JsonField<"plugin", &StatusEnvelope::plugin>,
+    JsonField<"version", &StatusEnvelope::version>,
+    JsonField<"playerCount", &StatusEnvelope::playerCount>>;
+
+struct ServerEnvelope {
+    std::string_view levelName;
+    size_t playerCount = 0;
+    std::string_view status;
+};
+using ServerJson = JsonSchema<
+    JsonField<"levelName", &ServerEnvelope::levelName>,
+    JsonField<"playerCount", &ServerEnvelope::playerCount>,
+    JsonField<"status", &ServerEnvelope::status>>;
+
+struct CountEnvelope {
+    size_t count = 0;
+};
+using CountJson = JsonSchema<JsonField<"count", &CountEnvelope::count>>;
+
+// 玩家列表，Ptr 为快照中的 shared_ptr 或搜索结果中的裸指针
+template <typename Ptr>
+struct PlayerListEnvelope {
+    std::span<const Ptr> players;
+    size_t count = 0;
+};
+template <typename Ptr>
+using PlayerListJson = JsonSchema<
+    JsonField<"players", &PlayerListEnvelope<Ptr>::players>,
+    JsonField<"count", &PlayerListEnvelope<Ptr>::count>>;
+
+} // namespace serverinfo_rest
@@ -0,0 +1,40 @@
+#include "mod/PlayerSampler.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace serverinfo_rest {
+
+const PlayerSample* PlayerSampleFrame::find(std::string_view xuid) const {
+    auto it = std::lower_bound(players.begin(), players.end(), xuid,
+                               [](const PlayerSample& sample, std::string_view key) { return sample.xuid < key; });
+    return (it != players.end() && it->xuid == xuid) ? &*it : nullptr;
+}
+
+PlayerSampleFrame& PlayerSampler::beginSample() {
+    // 换下的缓冲区已经不在 mFront 中，新读者拿不到它；引用计数为 1 说明旧读者也都已释放
+    if (!mBack || mBack.use_count() > 1) {
+        mBack = std::make_shared<PlayerSampleFrame>();
+    } else {
+        // use_count() 是 relaxed 读取，本身不与读者释放引用时的递减同步；
+        // 读者的递减带有 release 语义，这里的 acquire 栅栏保证读者对旧帧的读取都先于下面的覆盖写入
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    // 不清空 players，调用方按下标覆盖已有元素以复用字符串的内存
+    return *mBack;
+}
+
+void PlayerSampler::publish() {
+    mBack->sequence = mSequence.load(std::memory_order_relaxed) + 1;
+    mFront.store(mBack, std::memory_order_release);
+    mSequence.store(mBack->sequence, std::memory_order_release);
+    std::swap(mBack, mFrontWritable);
+}
+
+void PlayerSampler::reset() {
+    mFront.store(nullptr, std::memory_order_release);
+    mBack.reset();
+    mFrontWritable.reset();
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 一次采样得到的单个玩家状态
+struct PlayerSample {
+    std::string xuid;
+    float posX = 0, posY = 0, posZ = 0;
+    int dimension = 0;
+    int health = 0;
+    int maxHealth = 0;
+    int ping = -1; // 平均延迟 (毫秒)，未知时为 -1
+};
+
+// 某一次采样的全部玩家状态
+struct PlayerSampleFrame {
+    uint64_t sequence = 0;             // 采样序号，每次发布递增
+    std::vector<PlayerSample> players; // 按 xuid 排序
+
+    const PlayerSample* find(std::string_view xuid) const; // O(log n)
+};
+
+// 游戏刻采样结果的双缓冲
+// 游戏线程在后台缓冲区中填充一整批数据，然后与前台缓冲区原子地交换；
+// HTTP 线程只读前台缓冲区，从不接触 Player 对象。
+// 被换下的旧前台缓冲区在没有读者持有时作为下一次的后台缓冲区复用，稳定状态下采样不分配内存。
+class PlayerSampler {
+public:
+    // 读者：当前前台缓冲区，尚未采样时为空
+    [[nodiscard]] std::shared_ptr<const PlayerSampleFrame> current() const {
+        return mFront.load(std::memory_order_acquire);
+    }
+
+    // 最近一次发布的采样序号，0 表示尚未采样
+    [[nodiscard]] uint64_t sequence() const { return mSequence.load(std::memory_order_acquire); }
+
+    // 写入方 (游戏线程)：取得后台缓冲区，填充 players 后调用 publish()
+    PlayerSampleFrame& beginSample();
+    void publish();
+
+    // 写入方：丢弃所有采样 (插件禁用时)
+    void reset();
+
+private:
+    std::atomic<std::shared_ptr<const PlayerSampleFrame>> mFront;
+    std::atomic<uint64_t> mSequence{0};
+
+    // 以下只在游戏线程访问
+    std::shared_ptr<PlayerSampleFrame> mBack;
+    std::shared_ptr<PlayerSampleFrame> mFrontWritable; // 与 mFront 指向同一对象，用于换下后复用
+};
+
+} // namespace serverinfo_rest
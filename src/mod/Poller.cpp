@@ -0,0 +1,264 @@
+#include "mod/Poller.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
+namespace serverinfo_rest::net {
+
+#if defined(__linux__)
+
+// ==================== epoll 后端 ====================
+
+struct Poller::Impl {
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic_bool wakePending{false};
+
+    std::vector<epoll_event> events = std::vector<epoll_event>(256);
+
+    static uint32_t toEpoll(uint32_t interest) {
+        uint32_t mask = 0;
+        if (interest & PollReadable) mask |= EPOLLIN | EPOLLRDHUP;
+        if (interest & PollWritable) mask |= EPOLLOUT;
+        return mask;
+    }
+};
+
+Poller::Poller() : mImpl(std::make_unique<Impl>()) {
+    mImpl->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    mImpl->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mImpl->epollFd >= 0 && mImpl->wakeFd >= 0) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = mImpl->wakeFd;
+        epoll_ctl(mImpl->epollFd, EPOLL_CTL_ADD, mImpl->wakeFd, &ev);
+    }
+}
+
+Poller::~Poller() {
+    if (mImpl->wakeFd >= 0) ::close(mImpl->wakeFd);
+    if (mImpl->epollFd >= 0) ::close(mImpl->epollFd);
+}
+
+bool Poller::isValid() const { return mImpl->epollFd >= 0 && mImpl->wakeFd >= 0; }
+
+bool Poller::add(Socket socket, uint32_t interest) {
+    epoll_event ev{};
+    ev.events = Impl::toEpoll(interest);
+    ev.data.fd = socket;
+    return epoll_ctl(mImpl->epollFd, EPOLL_CTL_ADD, socket, &ev) == 0;
+}
+
+bool Poller::modify(Socket socket, uint32_t interest) {
+    epoll_event ev{};
+    ev.events = Impl::toEpoll(interest);
+    ev.data.fd = socket;
+    return epoll_ctl(mImpl->epollFd, EPOLL_CTL_MOD, socket, &ev) == 0;
+}
+
+void Poller::remove(Socket socket) { epoll_ctl(mImpl->epollFd, EPOLL_CTL_DEL, socket, nullptr); }
+
+int Poller::wait(std::vector<PollResult>& results, int timeoutMs) {
+    results.clear();
+    int count = epoll_wait(mImpl->epollFd, mImpl->events.data(), static_cast<int>(mImpl->events.size()), timeoutMs);
+    if (count < 0) {
+        return isInterrupted(errno) ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const auto& ev = mImpl->events[i];
+        if (ev.data.fd == mImpl->wakeFd) {
+            uint64_t value;
+            while (::read(mImpl->wakeFd, &value, sizeof(value)) > 0) {}
+            mImpl->wakePending.store(false, std::memory_order_release);
+            continue;
+        }
+        uint32_t mask = 0;
+        // 对端半关闭 (RDHUP) 按可读处理，让调用方先读完剩余数据再由 recv 返回 0
+        if (ev.events & (EPOLLIN | EPOLLRDHUP)) mask |= PollReadable;
+        if (ev.events & EPOLLOUT) mask |= PollWritable;
+        if (ev.events & (EPOLLERR | EPOLLHUP)) mask |= PollError;
+        results.push_back({ev.data.fd, mask});
+    }
+
+    // 事件数组被填满时扩容，减少下一轮的系统调用次数
+    if (count == static_cast<int>(mImpl->events.size())) {
+        mImpl->events.resize(mImpl->events.size() * 2);
+    }
+    return static_cast<int>(results.size());
+}
+
+void Poller::wakeup() {
+    // 合并多次唤醒，事件循环处理前只写一次 eventfd
+    if (mImpl->wakePending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(mImpl->wakeFd, &one, sizeof(one));
+}
+
+const char* Poller::backendName() const { return "epoll"; }
+
+#else
+
+// ==================== WSAPoll / poll 后端 ====================
+
+#ifdef _WIN32
+using PollFd = WSAPOLLFD;
+static int pollSockets(PollFd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+#else
+using PollFd = pollfd;
+static int pollSockets(PollFd* fds, size_t count, int timeoutMs) {
+    return ::poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+#endif
+
+struct Poller::Impl {
+    // 用一个连接到自身的 UDP socket 作为唤醒通道 (Windows 没有 eventfd/pipe 可供 WSAPoll 使用)
+    Socket wakeSocket = kInvalidSocket;
+    std::atomic_bool wakePending{false};
+
+    std::vector<PollFd> fds;   // fds[0] 固定为唤醒 socket
+    std::unordered_map<Socket, size_t> index; // socket -> fds 下标
+
+    static short toPoll(uint32_t interest) {
+        short mask = 0;
+        if (interest & PollReadable) mask |= POLLIN;
+        if (interest & PollWritable) mask |= POLLOUT;
+        return mask;
+    }
+
+    bool createWakeSocket() {
+        wakeSocket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (wakeSocket == kInvalidSocket) {
+            return false;
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        SockLen addrLen = sizeof(addr);
+        if (bind(wakeSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || getsockname(wakeSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0
+            || connect(wakeSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            closeSocket(wakeSocket);
+            wakeSocket = kInvalidSocket;
+            return false;
+        }
+        setNonBlocking(wakeSocket);
+        return true;
+    }
+};
+
+Poller::Poller() : mImpl(std::make_unique<Impl>()) {
+    if (mImpl->createWakeSocket()) {
+        PollFd wake{};
+        wake.fd = mImpl->wakeSocket;
+        wake.events = POLLIN;
+        mImpl->fds.push_back(wake);
+    }
+}
+
+Poller::~Poller() {
+    if (mImpl->wakeSocket != kInvalidSocket) {
+        closeSocket(mImpl->wakeSocket);
+    }
+}
+
+bool Poller::isValid() const { return mImpl->wakeSocket != kInvalidSocket; }
+
+bool Poller::add(Socket socket, uint32_t interest) {
+    if (mImpl->index.count(socket)) {
+        return false;
+    }
+    PollFd entry{};
+    entry.fd = socket;
+    entry.events = Impl::toPoll(interest);
+    mImpl->index[socket] = mImpl->fds.size();
+    mImpl->fds.push_back(entry);
+    return true;
+}
+
+bool Poller::modify(Socket socket, uint32_t interest) {
+    auto it = mImpl->index.find(socket);
+    if (it == mImpl->index.end()) {
+        return false;
+    }
+    mImpl->fds[it->second].events = Impl::toPoll(interest);
+    return true;
+}
+
+void Poller::remove(Socket socket) {
+    auto it = mImpl->index.find(socket);
+    if (it == mImpl->index.end()) {
+        return;
+    }
+    // 与末尾元素交换后删除，保持 O(1)
+    size_t pos = it->second;
+    size_t last = mImpl->fds.size() - 1;
+    if (pos != last) {
+        mImpl->fds[pos] = mImpl->fds[last];
+        mImpl->index[mImpl->fds[pos].fd] = pos;
+    }
+    mImpl->fds.pop_back();
+    mImpl->index.erase(it);
+}
+
+int Poller::wait(std::vector<PollResult>& results, int timeoutMs) {
+    results.clear();
+    int count = pollSockets(mImpl->fds.data(), mImpl->fds.size(), timeoutMs);
+    if (count < 0) {
+        return isInterrupted(lastError()) ? 0 : -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    if (mImpl->fds[0].revents & POLLIN) {
+        char drain[64];
+        while (recv(mImpl->wakeSocket, drain, sizeof(drain), 0) > 0) {}
+        mImpl->wakePending.store(false, std::memory_order_release);
+    }
+
+    for (size_t i = 1; i < mImpl->fds.size(); ++i) {
+        short revents = mImpl->fds[i].revents;
+        if (revents == 0) {
+            continue;
+        }
+        uint32_t mask = 0;
+        if (revents & POLLIN) mask |= PollReadable;
+        if (revents & POLLOUT) mask |= PollWritable;
+        if (revents & (POLLERR | POLLHUP | POLLNVAL)) mask |= PollError;
+        results.push_back({mImpl->fds[i].fd, mask});
+    }
+    return static_cast<int>(results.size());
+}
+
+void Poller::wakeup() {
+    if (mImpl->wakePending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    char one = 1;
+    send(mImpl->wakeSocket, &one, 1, 0);
+}
+
+const char* Poller::backendName() const {
+#ifdef _WIN32
+    return "WSAPoll";
+#else
+    return "poll";
+#endif
+}
+
+#endif
+
+} // namespace serverinfo_rest::net
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "mod/Socket.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace serverinfo_rest::net {
+
+// 就绪事件
+enum PollEvent : uint32_t {
+    PollNone = 0,
+    PollReadable = 1 << 0,
+    PollWritable = 1 << 1,
+    PollError = 1 << 2, // 出错或对端挂断
+};
+
+struct PollResult {
+    Socket socket;
+    uint32_t events;
+};
+
+// 基于就绪通知的事件多路复用器 (水平触发)
+// Linux 使用 epoll，Windows 使用 WSAPoll，其他平台退化为 poll
+// 除 wakeup() 外，所有方法只能在事件循环线程中调用
+class Poller {
+public:
+    Poller();
+    ~Poller();
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    [[nodiscard]] bool isValid() const;
+
+    bool add(Socket socket, uint32_t interest);
+    bool modify(Socket socket, uint32_t interest);
+    void remove(Socket socket);
+
+    // 等待事件，timeoutMs < 0 表示无限等待；返回就绪的 socket 数量，出错返回 -1
+    int wait(std::vector<PollResult>& results, int timeoutMs);
+
+    // 线程安全：唤醒阻塞在 wait() 中的事件循环
+    void wakeup();
+
+    // 当前使用的后端名称，用于日志
+    [[nodiscard]] const char* backendName() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace serverinfo_rest::net
@@ -0,0 +1,153 @@
+#include "mod/RateLimiter.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace serverinfo_rest {
+
+RateLimiter::RateLimiter(size_t capacity, std::chrono::milliseconds idleTimeout)
+    : mEpoch(std::chrono::steady_clock::now()),
+      mIdleMs(static_cast<uint32_t>(std::clamp<int64_t>(idleTimeout.count(), 1, INT32_MAX))) {
+    size_t perShard = std::bit_ceil(std::max<size_t>(capacity / kShardCount, kMaxProbes));
+    mShardMask = perShard - 1;
+    for (auto& shard : mShards) {
+        shard.buckets = std::make_unique<Bucket[]>(perShard);
+    }
+}
+
+uint32_t RateLimiter::toMillis(std::chrono::steady_clock::time_point time) const {
+    // 32 位毫秒约 49 天回绕一次；只比较差值，而桶闲置不会超过 idleTimeout，回绕不影响结果
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(time - mEpoch).count();
+    return static_cast<uint32_t>(millis);
+}
+
+bool RateLimiter::isIdle(uint64_t state, uint32_t nowMs) const {
+    auto last = static_cast<uint32_t>(state >> 32);
+    uint32_t elapsed = nowMs - last;
+    // 差值超过 2^31 说明 last 比 now 新 (其他线程刚刚写入)
+    return elapsed < 0x80000000u && elapsed >= mIdleMs;
+}
+
+RateLimiter::Bucket* RateLimiter::findOrCreate(Shard& shard, uint64_t hash, uint32_t nowMs, uint64_t fullTokens) {
+    uint64_t fullState = (static_cast<uint64_t>(nowMs) << 32) | kStateValid | fullTokens;
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        // 在探测窗口内查找 key，同时记下第一个可用的位置 (空位或已删除)
+        Bucket* vacant = nullptr;
+        Bucket* idle = nullptr;
+        size_t index = static_cast<size_t>(hash) & mShardMask;
+        for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+            Bucket& bucket = shard.buckets[(index + probe) & mShardMask];
+            uint64_t key = bucket.key.load(std::memory_order_acquire);
+            if (key == hash) {
+                return &bucket;
+            }
+            if (key == kEmptyKey) {
+                if (!vacant) vacant = &bucket;
+                break; // 空位之后不可能再有这个 key
+            }
+            if (key == kDeletedKey) {
+                if (!vacant) vacant = &bucket;
+            } else if (!idle && isIdle(bucket.state.load(std::memory_order_relaxed), nowMs)) {
+                idle = &bucket;
+            }
+        }
+
+        // 优先占用空位；窗口已满时直接接管闲置的桶，不必等到下一次回收
+        Bucket* target = vacant ? vacant : idle;
+        if (!target) {
+            return nullptr;
+        }
+        uint64_t expected = target->key.load(std::memory_order_relaxed);
+        if ((expected == kEmptyKey || expected == kDeletedKey || target == idle) &&
+            target->key.compare_exchange_strong(expected, hash, std::memory_order_acq_rel)) {
+            target->state.store(fullState, std::memory_order_release);
+            if (target != idle) {
+                shard.tracked.fetch_add(1, std::memory_order_relaxed);
+            }
+            return target;
+        }
+        // 被其他线程抢先，重新查找 (可能正是同一个 key)
+    }
+    return nullptr;
+}
+
+bool RateLimiter::tryAcquire(std::string_view key, const RateLimitRule& rule,
+                             std::chrono::steady_clock::time_point now, std::chrono::milliseconds& retryAfter) {
+    if (rule.ratePerSecond == 0) {
+        return true;
+    }
+    // 0 和 1 是保留值
+    uint64_t hash = std::hash<std::string_view>{}(key);
+    if (hash <= kDeletedKey) hash += 2;
+
+    Shard& shard = mShards[(hash >> 32) % kShardCount];
+    uint32_t nowMs = toMillis(now);
+    uint64_t capacity = static_cast<uint64_t>(std::max<uint32_t>(rule.burst, 1)) * kTokenScale;
+    Bucket* bucket = findOrCreate(shard, hash, nowMs, capacity);
+    if (!bucket) {
+        return true;
+    }
+
+    // 每秒补充 ratePerSecond 个令牌，即每毫秒补充 ratePerSecond 个千分之一令牌
+    uint64_t state = bucket->state.load(std::memory_order_acquire);
+    while (true) {
+        auto last = static_cast<uint32_t>(state >> 32);
+        uint32_t elapsed = nowMs - last;
+        if (elapsed >= 0x80000000u) elapsed = 0;
+        uint64_t refill = static_cast<uint64_t>(elapsed) * rule.ratePerSecond;
+        // 刚创建的桶可能还没写入初始状态，按满桶处理
+        uint64_t tokens = (state & kStateValid) ? std::min(capacity, (state & kTokenMask) + refill) : capacity;
+
+        if (tokens < kTokenScale) {
+            // 拒绝时不写回状态，补充的令牌下次按同一个起点计算
+            uint64_t waitMs = (kTokenScale - tokens + rule.ratePerSecond - 1) / rule.ratePerSecond;
+            retryAfter = std::chrono::milliseconds(waitMs);
+            shard.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint64_t next = (static_cast<uint64_t>(nowMs) << 32) | kStateValid | (tokens - kTokenScale);
+        if (bucket->state.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+}
+
+size_t RateLimiter::evictIdle(std::chrono::steady_clock::time_point now) {
+    uint32_t nowMs = toMillis(now);
+    size_t evicted = 0;
+    for (auto& shard : mShards) {
+        for (size_t i = 0; i <= mShardMask; ++i) {
+            Bucket& bucket = shard.buckets[i];
+            uint64_t key = bucket.key.load(std::memory_order_relaxed);
+            if (key <= kDeletedKey || !isIdle(bucket.state.load(std::memory_order_relaxed), nowMs)) {
+                continue;
+            }
+            // 标记为已删除而不是清空，后面同一探测链上的 key 仍然能被找到
+            if (bucket.key.compare_exchange_strong(key, kDeletedKey, std::memory_order_acq_rel)) {
+                shard.tracked.fetch_sub(1, std::memory_order_relaxed);
+                evicted++;
+            }
+        }
+    }
+    return evicted;
+}
+
+size_t RateLimiter::trackedCount() const {
+    size_t total = 0;
+    for (const auto& shard : mShards) {
+        total += shard.tracked.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t RateLimiter::rejectedCount() const {
+    uint64_t total = 0;
+    for (const auto& shard : mShards) {
+        total += shard.rejected.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // namespace serverinfo_rest
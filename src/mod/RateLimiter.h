@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace serverinfo_rest {
+
+// 令牌桶参数
+struct RateLimitRule {
+    uint32_t ratePerSecond = 0; // 每秒补充的令牌数，0 表示不限制
+    uint32_t burst = 0;         // 桶容量 (允许的突发请求数)
+};
+
+// 按客户端 (IP、token) 计数的令牌桶限流器，可在任意线程调用
+// 桶保存在分片的开放寻址表中，每个桶是 (key 哈希, 时间 + 令牌数) 两个原子变量，
+// 查找、创建和扣减都只用 CAS，不加锁。表满时不限流 (宁可放行也不误伤)。
+// 哈希冲突或并发创建同一个 key 时计数是近似的，误差不超过一个桶的容量。
+class RateLimiter {
+public:
+    // capacity 为最多同时跟踪的客户端数 (向上取整为 2 的幂)；闲置超过 idleTimeout 的桶会被回收
+    RateLimiter(size_t capacity, std::chrono::milliseconds idleTimeout);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    // 为 key 扣减一个令牌；超限时返回 false，retryAfter 为下一个令牌补充前需要等待的时间
+    bool tryAcquire(std::string_view key, const RateLimitRule& rule, std::chrono::steady_clock::time_point now,
+                    std::chrono::milliseconds& retryAfter);
+
+    // 回收闲置的桶 (闲置足够久的桶已经装满，回收后重新创建的效果相同)，返回回收的数量
+    size_t evictIdle(std::chrono::steady_clock::time_point now);
+
+    // 当前跟踪的客户端数和累计拒绝次数 (用于指标)
+    [[nodiscard]] size_t trackedCount() const;
+    [[nodiscard]] uint64_t rejectedCount() const;
+
+private:
+    // 桶状态：高 32 位为上次扣减的时间 (相对 mEpoch 的毫秒数)，第 31 位表示已初始化，低 31 位为剩余令牌 (千分之一个)
+    struct Bucket {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> state{0};
+    };
+
+    // 每个分片的计数器独占缓存行，不同分片的更新互不干扰
+    struct alignas(64) Shard {
+        std::unique_ptr<Bucket[]> buckets;
+        std::atomic<size_t> tracked{0};
+        std::atomic<uint64_t> rejected{0};
+    };
+
+    static constexpr size_t kShardCount = 16;
+    static constexpr size_t kMaxProbes = 16;
+    static constexpr uint64_t kEmptyKey = 0;
+    static constexpr uint64_t kDeletedKey = 1;
+    static constexpr uint64_t kTokenScale = 1000;
+    static constexpr uint64_t kStateValid = uint64_t(1) << 31;
+    static constexpr uint64_t kTokenMask = kStateValid - 1;
+
+    Bucket* findOrCreate(Shard& shard, uint64_t hash, uint32_t nowMs, uint64_t fullTokens);
+    [[nodiscard]] uint32_t toMillis(std::chrono::steady_clock::time_point time) const;
+    [[nodiscard]] bool isIdle(uint64_t state, uint32_t nowMs) const;
+
+    std::chrono::steady_clock::time_point mEpoch;
+    uint32_t mIdleMs;
+    size_t mShardMask; // 每个分片的桶数 - 1
+    Shard mShards[kShardCount];
+};
+
+} // namespace serverinfo_rest
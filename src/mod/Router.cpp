@@ -0,0 +1,205 @@
+#include "mod/Router.h"
+
+#include <array>
+
+namespace serverinfo_rest {
+
+HttpMethod parseHttpMethod(std::string_view method) {
+    if (method == "GET") return HttpMethod::Get;
+    if (method == "POST") return HttpMethod::Post;
+    return HttpMethod::Count_;
+}
+
+static constexpr const char* kMethodNames[] = {"GET", "POST"};
+static_assert(std::size(kMethodNames) == static_cast<size_t>(HttpMethod::Count_));
+
+struct Router::Node {
+    std::string prefix;                          // 静态边的标签
+    std::string indices;                         // 每个静态子节点 prefix 的首字符，与 children 一一对应
+    std::vector<std::unique_ptr<Node>> children; // 静态子节点
+    std::unique_ptr<Node> paramChild;            // 参数子节点 (每层最多一个)
+
+    // 仅参数节点使用
+    std::string paramName;
+    bool paramIsInt = false;
+
+    std::array<const RouteEntry*, static_cast<size_t>(HttpMethod::Count_)> handlers{};
+
+    [[nodiscard]] uint32_t methodMask() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i]) mask |= 1u << i;
+        }
+        return mask;
+    }
+
+    // 在 at 处拆分静态边：本节点保留前半段，后半段连同所有子节点移到新的子节点
+    void split(size_t at) {
+        auto tail = std::make_unique<Node>();
+        tail->prefix = prefix.substr(at);
+        tail->indices = std::move(indices);
+        tail->children = std::move(children);
+        tail->paramChild = std::move(paramChild);
+        tail->handlers = handlers;
+
+        prefix.resize(at);
+        indices.assign(1, tail->prefix[0]);
+        children.clear();
+        children.push_back(std::move(tail));
+        paramChild.reset();
+        handlers = {};
+    }
+};
+
+static bool isDigits(std::string_view value) {
+    for (char c : value) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+Router::Router() : mRoot(std::make_unique<Node>()) {}
+
+Router::~Router() = default;
+
+bool Router::add(HttpMethod method, std::string_view pattern, RouteHandler handler, RoutePriority priority) {
+    if (mFrozen || method == HttpMethod::Count_ || pattern.empty() || pattern[0] != '/') {
+        return false;
+    }
+
+    Node* node = mRoot.get();
+    std::string_view rest = pattern;
+    while (!rest.empty()) {
+        // 参数片段：必须占据完整的一段路径
+        if (rest[0] == '{') {
+            size_t closePos = rest.find('}');
+            if (closePos == std::string_view::npos || pattern[pattern.size() - rest.size() - 1] != '/') {
+                return false;
+            }
+            std::string_view spec = rest.substr(1, closePos - 1);
+            std::string_view after = rest.substr(closePos + 1);
+            if (!after.empty() && after[0] != '/') {
+                return false;
+            }
+
+            size_t colonPos = spec.find(':');
+            std::string_view name = spec.substr(0, colonPos);
+            std::string_view type = colonPos == std::string_view::npos ? std::string_view{} : spec.substr(colonPos + 1);
+            if (name.empty() || (!type.empty() && type != "int")) {
+                return false;
+            }
+
+            if (!node->paramChild) {
+                node->paramChild = std::make_unique<Node>();
+                node->paramChild->paramName = std::string(name);
+                node->paramChild->paramIsInt = type == "int";
+            } else if (node->paramChild->paramName != name || node->paramChild->paramIsInt != (type == "int")) {
+                // 同一位置的参数必须同名同类型，否则匹配结果有歧义
+                return false;
+            }
+            node = node->paramChild.get();
+            rest = after;
+            continue;
+        }
+
+        // 静态片段：沿公共前缀向下，必要时拆分已有的边
+        std::string_view text = rest.substr(0, rest.find('{'));
+        rest.remove_prefix(text.size());
+        while (!text.empty()) {
+            size_t index = node->indices.find(text[0]);
+            if (index == std::string::npos) {
+                auto child = std::make_unique<Node>();
+                child->prefix = std::string(text);
+                node->indices.push_back(text[0]);
+                node->children.push_back(std::move(child));
+                node = node->children.back().get();
+                break;
+            }
+
+            Node* child = node->children[index].get();
+            size_t common = 0;
+            while (common < child->prefix.size() && common < text.size() && child->prefix[common] == text[common]) {
+                ++common;
+            }
+            if (common < child->prefix.size()) {
+                child->split(common);
+            }
+            node = child;
+            text.remove_prefix(common);
+        }
+    }
+
+    auto& slot = node->handlers[static_cast<size_t>(method)];
+    if (slot) {
+        return false;
+    }
+
+    auto entry = std::make_unique<RouteEntry>();
+    entry->id = static_cast<uint32_t>(mRoutes.size());
+    entry->method = method;
+    entry->priority = priority;
+    entry->pattern = std::string(pattern);
+    entry->handler = std::move(handler);
+    slot = entry.get();
+    mRoutes.push_back(std::move(entry));
+    return true;
+}
+
+const Router::Node* Router::find(const Node* node, std::string_view path, PathParams& params) const {
+    if (path.empty()) {
+        return node->methodMask() != 0 ? node : nullptr;
+    }
+
+    // 静态子节点优先
+    size_t index = node->indices.find(path[0]);
+    if (index != std::string::npos) {
+        const Node* child = node->children[index].get();
+        if (path.substr(0, child->prefix.size()) == child->prefix) {
+            if (const Node* found = find(child, path.substr(child->prefix.size()), params)) {
+                return found;
+            }
+        }
+    }
+
+    // 再尝试参数子节点，失败时回溯
+    if (const Node* child = node->paramChild.get(); child && params.count < PathParams::kCapacity) {
+        std::string_view value = path.substr(0, path.find('/'));
+        if (!value.empty() && (!child->paramIsInt || isDigits(value))) {
+            params.items[params.count++] = {child->paramName, value};
+            if (const Node* found = find(child, path.substr(value.size()), params)) {
+                return found;
+            }
+            --params.count;
+        }
+    }
+    return nullptr;
+}
+
+Router::Match Router::match(HttpMethod method, std::string_view path, PathParams& params) const {
+    params.count = 0;
+    const Node* node = find(mRoot.get(), path, params);
+    if (!node) {
+        return {};
+    }
+
+    Match result;
+    result.allowedMethods = node->methodMask();
+    if (method != HttpMethod::Count_) {
+        result.route = node->handlers[static_cast<size_t>(method)];
+    }
+    return result;
+}
+
+std::string Router::formatAllow(uint32_t methods) {
+    std::string allow;
+    for (size_t i = 0; i < std::size(kMethodNames); ++i) {
+        if (methods & (1u << i)) {
+            allow += kMethodNames[i];
+            allow += ", ";
+        }
+    }
+    allow += "OPTIONS";
+    return allow;
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mod/HttpParser.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serverinfo_rest {
+
+struct HttpResponse;
+
+// 路由处理函数类型
+using RouteHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+enum class HttpMethod : uint8_t {
+    Get,
+    Post,
+    Count_
+};
+
+// 解析方法名，不支持的方法返回 Count_
+HttpMethod parseHttpMethod(std::string_view method);
+
+// 路由优先级：High 路由在事件循环中直接处理，不进入工作队列，工作线程全部繁忙时也能立即响应。
+// 只用于开销很小且不会阻塞的处理函数 (健康检查、计数等)
+enum class RoutePriority : uint8_t {
+    Normal,
+    High
+};
+
+struct RouteEntry {
+    uint32_t id = 0;     // 注册顺序，可作为数组下标
+    HttpMethod method = HttpMethod::Get;
+    RoutePriority priority = RoutePriority::Normal;
+    std::string pattern; // 注册时的路径模板，例如 /api/v1/player/{name}
+    RouteHandler handler;
+};
+
+// 基数树 (radix tree) 路由器
+// 路径模板支持静态片段和参数片段：{name} 匹配任意非空片段，{id:int} 只匹配数字。
+// 静态片段优先于参数片段。所有路由在 freeze() 之前注册，之后路由表只读，
+// match() 不加锁也不分配内存，可以被多个工作线程同时调用。
+class Router {
+public:
+    Router();
+    ~Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    // 注册路由，模板非法、重复注册或路由表已冻结时返回 false
+    bool add(HttpMethod method, std::string_view pattern, RouteHandler handler,
+             RoutePriority priority = RoutePriority::Normal);
+
+    // 冻结路由表
+    void freeze() { mFrozen = true; }
+    [[nodiscard]] bool isFrozen() const { return mFrozen; }
+
+    struct Match {
+        const RouteEntry* route = nullptr; // 方法和路径都匹配
+        uint32_t allowedMethods = 0;       // 路径匹配时支持的方法位掩码 (用于 405 的 Allow 头)
+    };
+
+    // 匹配路径，命中时把路径参数写入 params
+    Match match(HttpMethod method, std::string_view path, PathParams& params) const;
+
+    [[nodiscard]] const std::vector<std::unique_ptr<RouteEntry>>& routes() const { return mRoutes; }
+
+    // 把方法位掩码格式化为 Allow 头的值，例如 "GET, POST, OPTIONS"
+    static std::string formatAllow(uint32_t methods);
+
+private:
+    struct Node;
+
+    const Node* find(const Node* node, std::string_view path, PathParams& params) const;
+
+    std::unique_ptr<Node> mRoot;
+    std::vector<std::unique_ptr<RouteEntry>> mRoutes;
+    bool mFrozen = false;
+};
+
+} // namespace serverinfo_rest
@@ -1,5 +1,8 @@
 #include "mod/ServerInfoRestMod.h"
 #include "mod/HttpServer.h"
+#include "mod/Log.h"
+#include "mod/PlayerJson.h"
+#include "mod/PlayerFeed.h"
 
 #include "ll/api/mod/RegisterHelper.h"
 #include "ll/api/Config.h"
@@ -8,14 +11,23 @@
 #include "ll/api/event/EventBus.h"
 #include "ll/api/event/player/PlayerJoinEvent.h"
 #include "ll/api/event/player/PlayerDisconnectEvent.h"
+#include "ll/api/chrono/GameChrono.h"
+#include "ll/api/coro/CoroTask.h"
+#include "ll/api/thread/ServerThreadExecutor.h"
 
 #include "mc/world/actor/player/Player.h"
 #include "mc/world/level/Level.h"
+#include "mc/network/NetworkPeer.h"
 #include "mc/server/ServerLevel.h"
+#include "mc/world/level/storage/LevelData.h"
 
 #include <nlohmann/json.hpp>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <future>
 
 namespace serverinfo_rest {
 
@@ -41,126 +53,691 @@ ServerInfoRestMod& ServerInfoRestMod::getInstance() {
     return instance;
 }
 
+// ==================== 批量请求上下文 ====================
+
+// /batch 执行子请求期间固定的数据；子请求在外层请求的工作线程中同步执行，所以用线程局部变量传递
+struct BatchContext {
+    std::shared_ptr<const PlayerSnapshot> snapshot;
+    std::shared_ptr<const PlayerSampleFrame> samples;
+};
+
+static thread_local const BatchContext* tBatchContext = nullptr;
+
+// 在作用域内启用批次上下文，子请求抛出异常时同样会恢复
+class BatchScope {
+public:
+    explicit BatchScope(const BatchContext& context) : mPrevious(tBatchContext) { tBatchContext = &context; }
+    ~BatchScope() { tBatchContext = mPrevious; }
+    BatchScope(const BatchScope&) = delete;
+    BatchScope& operator=(const BatchScope&) = delete;
+
+private:
+    const BatchContext* mPrevious;
+};
+
 // ==================== 玩家缓存方法实现 ====================
 
-std::vector<CachedPlayerInfo> ServerInfoRestMod::getPlayerCache() const {
-    std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-    std::vector<CachedPlayerInfo> result;
-    result.reserve(mPlayerCache.size());
-    for (const auto& [xuid, info] : mPlayerCache) {
-        result.push_back(info);
+std::shared_ptr<const PlayerSnapshot> ServerInfoRestMod::getPlayerSnapshot() const {
+    if (tBatchContext) return tBatchContext->snapshot;
+    return mPlayerCache.snapshot();
+}
+
+uint64_t ServerInfoRestMod::getPlayerCacheGeneration() const {
+    if (tBatchContext) return tBatchContext->snapshot->generation;
+    return mPlayerCache.generation();
+}
+
+std::shared_ptr<const PlayerSampleFrame> ServerInfoRestMod::getPlayerSamples() const {
+    if (tBatchContext) return tBatchContext->samples;
+    return mSampler.current();
+}
+
+std::shared_ptr<const CachedPlayerInfo> ServerInfoRestMod::getPlayerByName(std::string_view name) const {
+    auto snapshot = getPlayerSnapshot();
+    const CachedPlayerInfo* info = snapshot->findByName(name);
+    if (!info) {
+        info = snapshot->findByNameIgnoreCase(name);
+    }
+    if (!info) {
+        return nullptr;
+    }
+    // 别名构造：返回的指针与快照共享生命周期，不复制玩家信息
+    return std::shared_ptr<const CachedPlayerInfo>(snapshot, info);
+}
+
+int ServerInfoRestMod::getPlayerCount() const {
+    return static_cast<int>(getPlayerSnapshot()->size());
+}
+
+std::shared_ptr<const EncodedBody> ServerInfoRestMod::getCachedResponse(CachedResponse which,
+                                                                      const PlayerSnapshot& snapshot) const {
+    auto& entry = mResponseCache[static_cast<size_t>(which)];
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    
+    // 快速路径：当前版本已经序列化过，直接共享
+    if (entry.body && entry.generation == snapshot.generation) {
+        return entry.body;
     }
-    getSelf().getLogger().trace("getPlayerCache() called, returning {} players", result.size());
-    return result;
+    
+    auto body = std::make_shared<const EncodedBody>(buildResponseBody(which, snapshot));
+    // 批次固定的旧快照或请求开始时取到的快照可能落后于缓存，不能覆盖更新的缓存
+    if (!entry.body || snapshot.generation > entry.generation) {
+        entry.body = body;
+        entry.generation = snapshot.generation;
+    }
+    LOG_TRACE(getSelf().getLogger(), "[Cache] Rebuilt response {} for generation {}", static_cast<int>(which),
+              snapshot.generation);
+    return body;
+}
+
+std::string ServerInfoRestMod::makeETag(uint64_t generation, std::string_view variant) const {
+    char buffer[64];
+    auto hash = std::hash<std::string_view>{}(variant);
+    int length = std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx-%llx\"",
+                               static_cast<unsigned long long>(mETagEpoch), static_cast<unsigned long long>(generation),
+                               static_cast<unsigned long long>(hash));
+    return std::string(buffer, static_cast<size_t>(length));
 }
 
-std::optional<CachedPlayerInfo> ServerInfoRestMod::getPlayerByName(const std::string& name) const {
-    std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-    getSelf().getLogger().trace("getPlayerByName() called for: {}", name);
-    for (const auto& [xuid, info] : mPlayerCache) {
-        if (info.name == name) {
-            getSelf().getLogger().trace("Found player {} in cache (xuid: {})", name, xuid);
-            return info;
+std::string ServerInfoRestMod::buildResponseBody(CachedResponse which, const PlayerSnapshot& snapshot) const {
+    const auto& players = snapshot.players;
+    std::string out;
+    out.reserve(64 + players.size() * 128);
+    JsonWriter json(out);
+    switch (which) {
+    case CachedResponse::Status:
+        StatusJson::write(json, StatusEnvelope{"online", "serverinfo-rest", "1.0.0", players.size()});
+        break;
+    case CachedResponse::Players:
+        using SnapshotPlayer = std::shared_ptr<const CachedPlayerInfo>;
+        PlayerListJson<SnapshotPlayer>::write(json, PlayerListEnvelope<SnapshotPlayer>{players, players.size()});
+        break;
+    case CachedResponse::PlayerNames:
+        json.beginObject().key("names").beginArray();
+        for (const auto& player : players) {
+            json.value(player->name);
         }
+        json.endArray().field("count", players.size()).endObject();
+        break;
+    case CachedResponse::PlayerCount:
+        CountJson::write(json, CountEnvelope{players.size()});
+        break;
+    case CachedResponse::Count_:
+        json.beginObject().endObject();
+        break;
     }
-    getSelf().getLogger().trace("Player {} not found in cache", name);
-    return std::nullopt;
+    return out;
 }
 
-int ServerInfoRestMod::getPlayerCount() const {
-    std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-    int count = static_cast<int>(mPlayerCache.size());
-    getSelf().getLogger().trace("getPlayerCount() = {}", count);
-    return count;
+void ServerInfoRestMod::queryPlayers(const HttpRequest& req, HttpResponse& res) const {
+    auto badRequest = [&res](std::string_view error) {
+        res.setStatus(400, "Bad Request");
+        std::string body;
+        JsonWriter(body).beginObject().field("error", error).endObject();
+        res.setJson(body);
+    };
+    
+    // fields: 逗号分隔的字段名，未指定时与完整列表相同
+    uint32_t fields = kDefaultPlayerFields;
+    std::string_view fieldsParam = req.getParam("fields");
+    if (!fieldsParam.empty()) {
+        std::string_view unknown;
+        fields = parsePlayerFields(fieldsParam, unknown);
+        if (fields == 0) {
+            badRequest("Unknown field '" + std::string(unknown) + "', available: " + std::string(playerFieldNames()));
+            return;
+        }
+    }
+    
+    // op: true / false
+    std::string_view opParam = req.getParam("op");
+    if (!opParam.empty() && opParam != "true" && opParam != "false") {
+        badRequest("Invalid 'op' parameter, expected true or false");
+        return;
+    }
+    std::string_view locale = req.getParam("locale");
+    
+    // limit: 每页最多返回的玩家数；cursor: 上一页返回的 nextCursor
+    size_t limit = SIZE_MAX;
+    if (auto limitParam = req.getParam("limit"); !limitParam.empty()) {
+        auto [ptr, ec] = std::from_chars(limitParam.data(), limitParam.data() + limitParam.size(), limit);
+        if (ec != std::errc() || ptr != limitParam.data() + limitParam.size() || limit == 0) {
+            badRequest("Invalid 'limit' parameter");
+            return;
+        }
+        limit = std::min<size_t>(limit, 1000);
+    }
+    std::string_view cursor = req.getParam("cursor");
+    
+    // 采样字段只在请求时读取，ETag 也只在这时随采样变化
+    auto snapshot = getPlayerSnapshot();
+    std::shared_ptr<const PlayerSampleFrame> samples;
+    if (fields & kSampledPlayerFields) {
+        samples = getPlayerSamples();
+    }
+    std::string variant = "/players?" + std::to_string(fields) + "&" + std::string(opParam) + "&" + std::string(locale)
+                        + "&" + std::to_string(limit) + "&" + std::string(cursor) + "@"
+                        + std::to_string(samples ? samples->sequence : 0);
+    if (applyETag(req, res, makeETag(snapshot->generation, variant))) return;
+    
+    // 快照按 xuid 排序，cursor 是上一页最后一个玩家的 xuid，玩家加入或离开不会导致重复或遗漏
+    const auto& players = snapshot->players;
+    auto it = players.begin();
+    if (!cursor.empty()) {
+        it = std::upper_bound(players.begin(), players.end(), cursor,
+                              [](std::string_view key, const auto& player) { return key < player->xuid; });
+    }
+    
+    std::string body;
+    body.reserve(64 + std::min(limit, players.size()) * 128);
+    JsonWriter json(body);
+    json.beginObject().key("players").beginArray();
+    size_t count = 0;
+    const CachedPlayerInfo* last = nullptr;
+    bool more = false;
+    for (; it != players.end(); ++it) {
+        const auto& player = **it;
+        if (!opParam.empty() && player.isOperator != (opParam == "true")) continue;
+        if (!locale.empty() && player.locale != locale) continue;
+        if (count == limit) {
+            more = true;
+            break;
+        }
+        json.beginObject();
+        writePlayerFields(json, player, samples ? samples->find(player.xuid) : nullptr, fields);
+        json.endObject();
+        last = &player;
+        count++;
+    }
+    json.endArray().field("count", count);
+    if (more) {
+        json.field("nextCursor", last->xuid);
+    }
+    json.endObject();
+    
+    LOG_DEBUG(getSelf().getLogger(), "[API] /players query returned {} players{}", count, more ? " (more)" : "");
+    res.setJson(body);
+}
+
+void ServerInfoRestMod::runBatch(const HttpRequest& req, HttpResponse& res) const {
+    auto badRequest = [&res](std::string_view error) {
+        res.setStatus(400, "Bad Request");
+        std::string body;
+        JsonWriter(body).beginObject().field("error", error).endObject();
+        res.setJson(body);
+    };
+    
+    // 请求体: {"requests": ["/api/v1/status", {"path": "/api/v1/player", "query": "name=Steve"}, ...]}
+    auto parsed = nlohmann::json::parse(req.body.begin(), req.body.end(), nullptr, false);
+    if (parsed.is_discarded() || !parsed.is_object() || !parsed.contains("requests") ||
+        !parsed["requests"].is_array()) {
+        badRequest("Expected a JSON object with a 'requests' array");
+        return;
+    }
+    const auto& items = parsed["requests"];
+    if (items.empty() || items.size() > static_cast<size_t>(std::max(1, mConfig.batchMaxRequests))) {
+        badRequest("'requests' must contain 1 to " + std::to_string(std::max(1, mConfig.batchMaxRequests))
+                   + " sub-requests");
+        return;
+    }
+    
+    // 先校验全部子请求，避免执行到一半才发现格式错误；子请求中的视图指向这里
+    std::vector<std::string> targets;
+    targets.reserve(items.size());
+    for (const auto& item : items) {
+        std::string target;
+        if (item.is_string()) {
+            target = item.get<std::string>();
+        } else if (item.is_object() && item.contains("path") && item["path"].is_string()) {
+            target = item["path"].get<std::string>();
+            if (item.contains("query") && item["query"].is_string()) {
+                std::string query = item["query"].get<std::string>();
+                if (!query.empty()) target += "?" + query;
+            }
+        }
+        if (target.empty() || target.front() != '/') {
+            badRequest("Sub-request #" + std::to_string(targets.size())
+                       + " must be a path string or an object with an absolute 'path'");
+            return;
+        }
+        targets.push_back(std::move(target));
+    }
+    
+    // 固定快照和采样帧：所有子请求看到同一个玩家列表，token 也只在外层验证一次
+    BatchContext context{getPlayerSnapshot(), getPlayerSamples()};
+    BatchScope scope(context);
+    
+    std::string body;
+    body.reserve(256 * targets.size());
+    JsonWriter json(body);
+    json.beginObject().field("generation", context.snapshot->generation).key("responses").beginArray();
+    for (const auto& target : targets) {
+        std::string_view targetView = target;
+        size_t queryPos = targetView.find('?');
+        HttpRequest sub;
+        sub.method = "GET";
+        sub.version = req.version;
+        sub.path = targetView.substr(0, queryPos);
+        if (queryPos != std::string_view::npos) {
+            sub.query = targetView.substr(queryPos + 1);
+            parseQueryString(sub.query, sub.params);
+        }
+        
+        HttpResponse subRes;
+        mHttpServer->dispatchSubrequest(sub, subRes);
+        // 事件流和 WebSocket 需要独占连接，不能放进批量响应
+        if (subRes.eventStream || subRes.webSocket) {
+            subRes = HttpResponse{};
+            subRes.setStatus(400, "Bad Request");
+            subRes.setJson("{\"error\": \"Streaming endpoints cannot be batched\"}");
+        }
+        
+        json.beginObject().field("path", target).field("status", subRes.statusCode);
+        std::string_view subBody = subRes.getBody();
+        auto contentType = subRes.headers.find("Content-Type");
+        if (subBody.empty()) {
+            json.field("body", nullptr);
+        } else if (contentType != subRes.headers.end() && contentType->second.starts_with("application/json")) {
+            json.key("body").rawValue(subBody);
+        } else {
+            json.field("body", subBody);
+        }
+        json.endObject();
+    }
+    json.endArray().field("count", targets.size()).endObject();
+    
+    LOG_DEBUG(getSelf().getLogger(), "[API] /batch ran {} sub-requests on generation {}", targets.size(),
+              context.snapshot->generation);
+    res.setJson(body);
 }
 
 void ServerInfoRestMod::onPlayerJoin(const std::string& xuid, const CachedPlayerInfo& info) {
-    std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-    mPlayerCache[xuid] = info;
-    getSelf().getLogger().info("[Cache] Player joined: {} (xuid: {})", info.name, xuid);
-    getSelf().getLogger().debug("[Cache] Player details - uuid: {}, ip: {}, locale: {}, op: {}", 
-                                 info.uuid, info.ipAndPort, info.locale, info.isOperator);
-    getSelf().getLogger().trace("[Cache] Player position: ({:.2f}, {:.2f}, {:.2f})", 
-                                 info.posX, info.posY, info.posZ);
-    getSelf().getLogger().debug("[Cache] Total players in cache: {}", mPlayerCache.size());
+    // 复制-修改-发布，不会等待任何 HTTP 读者
+    mPlayerCache.upsert(info);
+    mJoinCount++;
+    LOG_INFO(getSelf().getLogger(), "[Cache] Player joined: {} (xuid: {})", info.name, xuid);
+    LOG_DEBUG(getSelf().getLogger(), "[Cache] Player details - uuid: {}, ip: {}, locale: {}, op: {}", 
+              info.uuid, info.ipAndPort, info.locale, info.isOperator);
+    LOG_TRACE(getSelf().getLogger(), "[Cache] Player position: ({:.2f}, {:.2f}, {:.2f})", 
+              info.posX, info.posY, info.posZ);
+    LOG_DEBUG(getSelf().getLogger(), "[Cache] Total players in cache: {}", getPlayerCount());
+    
+    // 推送给事件流订阅者
+    if (mHttpServer) {
+        mHttpServer->publishEvent("join", toJson<PlayerSummaryJson>(info));
+        mHttpServer->notifyWebSockets();
+    }
 }
 
 void ServerInfoRestMod::onPlayerLeave(const std::string& xuid) {
-    std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-    auto it = mPlayerCache.find(xuid);
-    if (it != mPlayerCache.end()) {
-        std::string name = it->second.name;
-        mPlayerCache.erase(it);
-        getSelf().getLogger().info("[Cache] Player left: {} (xuid: {})", name, xuid);
-        getSelf().getLogger().debug("[Cache] Total players in cache: {}", mPlayerCache.size());
+    if (auto removed = mPlayerCache.remove(xuid)) {
+        mLeaveCount++;
+        LOG_INFO(getSelf().getLogger(), "[Cache] Player left: {} (xuid: {})", removed->name, xuid);
+        LOG_DEBUG(getSelf().getLogger(), "[Cache] Total players in cache: {}", getPlayerCount());
+        
+        if (mHttpServer) {
+            mHttpServer->publishEvent("leave", toJson<PlayerRefJson>(*removed));
+            mHttpServer->notifyWebSockets();
+        }
+    } else {
+        LOG_WARN(getSelf().getLogger(), "[Cache] Tried to remove unknown player with xuid: {}", xuid);
+    }
+}
+
+// ==================== 游戏刻采样 ====================
+
+void ServerInfoRestMod::startTickTasks() {
+    auto& logger = getSelf().getLogger();
+    mTickTasksRunning = std::make_shared<std::atomic<bool>>(true);
+    auto& executor = ll::thread::ServerThreadExecutor::getDefault();
+    
+    if (mConfig.sampleIntervalTicks > 0) {
+        int interval = mConfig.sampleIntervalTicks;
+        ll::coro::keepThis([this, interval, running = mTickTasksRunning]() -> ll::coro::CoroTask<> {
+            while (running->load()) {
+                co_await ll::chrono::ticks(interval);
+                if (!running->load()) break;
+                samplePlayers();
+            }
+            co_return;
+        }).launch(executor);
+        LOG_INFO(logger, "Player state sampler started (every {} ticks)", interval);
     } else {
-        getSelf().getLogger().warn("[Cache] Tried to remove unknown player with xuid: {}", xuid);
+        LOG_INFO(logger, "Player state sampler disabled");
     }
+    
+    // 每刻一次：合并执行工作线程提交的游戏数据查询，没有查询时只检查一个原子标志
+    ll::coro::keepThis([queries = mGameQueries, running = mTickTasksRunning]() -> ll::coro::CoroTask<> {
+        while (running->load()) {
+            co_await ll::chrono::ticks(1);
+            if (!running->load()) break;
+            if (queries->hasPending()) {
+                queries->runPending();
+            }
+        }
+        co_return;
+    }).launch(executor);
+    
+    // 每 20 刻记录一次历史数据，同时用实际经过的墙钟时间算出平均每刻间隔 (不是刻内逻辑的执行耗时)
+    ll::coro::keepThis([this, running = mTickTasksRunning]() -> ll::coro::CoroTask<> {
+        constexpr int kTicks = 20;
+        auto last = std::chrono::steady_clock::now();
+        while (running->load()) {
+            co_await ll::chrono::ticks(kTicks);
+            if (!running->load()) break;
+            auto now = std::chrono::steady_clock::now();
+            recordHistory(std::chrono::duration<double, std::milli>(now - last).count() / kTicks);
+            last = now;
+        }
+        co_return;
+    }).launch(executor);
+}
+
+void ServerInfoRestMod::stopTickTasks() {
+    if (mTickTasksRunning) {
+        mTickTasksRunning->store(false);
+        mTickTasksRunning.reset();
+    }
+    mSampler.reset();
+}
+
+// 运行在游戏线程：每秒一次，把当前值累加进各个分辨率的桶
+void ServerInfoRestMod::recordHistory(double tickIntervalMs) {
+    auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+    uint64_t joins = mJoinCount.load();
+    uint64_t leaves = mLeaveCount.load();
+    
+    mHistory[static_cast<size_t>(HistoryMetric::Players)].record(now, getPlayerCount());
+    mHistory[static_cast<size_t>(HistoryMetric::Joins)].record(now, static_cast<double>(joins - mRecordedJoins));
+    mHistory[static_cast<size_t>(HistoryMetric::Leaves)].record(now, static_cast<double>(leaves - mRecordedLeaves));
+    mHistory[static_cast<size_t>(HistoryMetric::TickInterval)].record(now, tickIntervalMs);
+    mRecordedJoins = joins;
+    mRecordedLeaves = leaves;
+    mTickIntervalMs.store(tickIntervalMs, std::memory_order_relaxed);
 }
 
+std::string ServerInfoRestMod::buildMetrics() const {
+    std::string out;
+    out.reserve(4096);
+    
+    auto metric = [&out](const char* name, const char* type, const char* help, const std::string& value) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+        out += name;
+        out += ' ';
+        out += value;
+        out += '\n';
+    };
+    
+    metric("serverinfo_players_online", "gauge", "Players currently online.", std::to_string(getPlayerCount()));
+    metric("serverinfo_player_joins_total", "counter", "Player joins since the plugin was loaded.",
+           std::to_string(mJoinCount.load(std::memory_order_relaxed)));
+    metric("serverinfo_player_leaves_total", "counter", "Player leaves since the plugin was loaded.",
+           std::to_string(mLeaveCount.load(std::memory_order_relaxed)));
+    metric("serverinfo_tick_interval_milliseconds", "gauge",
+           "Average wall-clock interval between server ticks over the last 20 ticks (50 at full speed).",
+           std::to_string(mTickIntervalMs.load(std::memory_order_relaxed)));
+    if (mGameQueries) {
+        metric("serverinfo_game_queries_total", "counter", "Game-thread queries executed (after merging).",
+               std::to_string(mGameQueries->executedCount()));
+        metric("serverinfo_game_queries_merged_total", "counter",
+               "Game-thread queries merged into an identical pending query.",
+               std::to_string(mGameQueries->mergedCount()));
+        metric("serverinfo_game_queries_rejected_total", "counter",
+               "Game-thread queries rejected because too many were pending.",
+               std::to_string(mGameQueries->rejectedCount()));
+    }
+    
+    if (mHttpServer) {
+        mHttpServer->appendMetrics(out);
+    }
+    return out;
+}
+
+std::string ServerInfoRestMod::buildDebugStats() const {
+    const LatencyStats* stats = mHttpServer ? mHttpServer->latencyStats() : nullptr;
+    if (!stats) {
+        return "{}";
+    }
+    
+    auto summarize = [](const HistogramSnapshot& histogram) {
+        return nlohmann::json{
+            {"count", histogram.count},
+            {"mean",  histogram.mean()},
+            {"p50",   histogram.percentile(0.5)},
+            {"p90",   histogram.percentile(0.9)},
+            {"p99",   histogram.percentile(0.99)},
+            {"p999",  histogram.percentile(0.999)},
+            {"max",   histogram.max}
+        };
+    };
+    
+    auto snapshot = stats->snapshot();
+    nlohmann::json json;
+    json["unit"] = "us";
+    json["threads"] = snapshot.threads;
+    
+    auto& phases = json["phases"] = nlohmann::json::object();
+    for (size_t i = 0; i < snapshot.phases.size(); ++i) {
+        phases[latencyPhaseName(static_cast<LatencyPhase>(i))] = summarize(snapshot.phases[i]);
+    }
+    
+    // 只列出收到过请求的路由
+    auto& routes = json["routes"] = nlohmann::json::object();
+    for (size_t slot = 0; slot < snapshot.routeHandler.size(); ++slot) {
+        const auto& handler = snapshot.routeHandler[slot];
+        const auto& total = snapshot.routeTotal[slot];
+        if (handler.count == 0 && total.count == 0) continue;
+        routes[mHttpServer->routeLabel(slot)] = {{"handler", summarize(handler)}, {"total", summarize(total)}};
+    }
+    return json.dump();
+}
+
+// ==================== 游戏线程查询 ====================
+
+bool ServerInfoRestMod::queryGame(const std::string& key, GameQueryFn query, HttpResponse& res,
+                                  std::string& result) const {
+    auto& logger = getSelf().getLogger();
+    auto shuttingDown = [&res] {
+        res.setStatus(503, "Service Unavailable");
+        res.setJson("{\"error\": \"Server is shutting down\"}");
+    };
+    
+    std::shared_future<std::string> future;
+    auto status = mGameQueries ? mGameQueries->submit(key, std::move(query), future) : GameQueryStatus::Stopped;
+    if (status == GameQueryStatus::Stopped) {
+        LOG_DEBUG(logger, "[API] Game query '{}' rejected: plugin is disabling", key);
+        shuttingDown();
+        return false;
+    }
+    if (status == GameQueryStatus::Full) {
+        LOG_WARN(logger, "[API] Game query '{}' rejected: too many pending queries", key);
+        res.setStatus(503, "Service Unavailable");
+        res.headers["Retry-After"] = "1";
+        res.setJson("{\"error\": \"Too many pending game queries\"}");
+        return false;
+    }
+    
+    // 超时后放弃等待；查询仍会在游戏线程中执行，结果由共享状态丢弃
+    int timeoutMs = std::max(1, mConfig.gameQueryTimeout);
+    if (future.wait_for(std::chrono::milliseconds(timeoutMs)) != std::future_status::ready) {
+        LOG_WARN(logger, "[API] Game query '{}' timed out after {}ms", key, timeoutMs);
+        res.setStatus(504, "Gateway Timeout");
+        res.setJson("{\"error\": \"Game thread did not respond in time\"}");
+        return false;
+    }
+    try {
+        result = future.get();
+    } catch (const std::exception& e) {
+        // 等待期间插件被禁用，未执行的查询以异常结束
+        if (mGameQueries->stopped()) {
+            LOG_DEBUG(logger, "[API] Game query '{}' abandoned: plugin is disabling", key);
+            shuttingDown();
+            return false;
+        }
+        LOG_ERROR(logger, "[API] Game query '{}' failed: {}", key, e.what());
+        res.setStatus(500, "Internal Server Error");
+        res.setJson("{\"error\": \"Game query failed\"}");
+        return false;
+    }
+    return true;
+}
+
+// 运行在游戏线程：一次遍历收集所有玩家的状态，然后整批发布
+void ServerInfoRestMod::samplePlayers() {
+    auto level = ll::service::getLevel();
+    if (!level) {
+        return;
+    }
+    
+    auto& frame = mSampler.beginSample();
+    size_t count = 0;
+    level->forEachPlayer([&frame, &count](Player& player) {
+        // 按下标覆盖上一轮留下的元素，复用其中字符串的内存
+        if (count == frame.players.size()) {
+            frame.players.emplace_back();
+        }
+        auto& sample = frame.players[count++];
+        sample.xuid = player.getXuid();
+        const auto& pos = player.getPosition();
+        sample.posX = pos.x;
+        sample.posY = pos.y;
+        sample.posZ = pos.z;
+        sample.dimension = player.getDimensionId().id;
+        sample.health = player.getHealth();
+        sample.maxHealth = player.getMaxHealth();
+        auto status = player.getNetworkStatus();
+        sample.ping = status ? static_cast<int>(status->mAveragePing) : -1;
+        return true;
+    });
+    frame.players.resize(count);
+    std::sort(frame.players.begin(), frame.players.end(),
+              [](const PlayerSample& a, const PlayerSample& b) { return a.xuid < b.xuid; });
+    mSampler.publish();
+    
+    if (mHttpServer) {
+        mHttpServer->notifyWebSockets();
+    }
+}
+
+// ==================== 历史数据 ====================
+
+static constexpr const char* kHistoryMetricNames[] = {"players", "joins", "leaves", "tickInterval"};
+static_assert(std::size(kHistoryMetricNames) == static_cast<size_t>(HistoryMetric::Count_));
+
 // ==================== 生命周期方法 ====================
 
 bool ServerInfoRestMod::load() {
     auto& logger = getSelf().getLogger();
     
     // ASCII Art Banner
-    logger.info("");
-    logger.info(R"(                                   _       ____                           __)");
-    logger.info(R"(   ________  ______   _____  _____(_)___  / __/___        ________  _____/ /_)");
-    logger.info(R"(  / ___/ _ \/ ___/ | / / _ \/ ___/ / __ \/ /_/ __ \______/ ___/ _ \/ ___/ __/)");
-    logger.info(R"( (__  )  __/ /   | |/ /  __/ /  / / / / / __/ /_/ /_____/ /  /  __(__  ) /_  )");
-    logger.info(R"(/____/\___/_/    |___/\___/_/  /_/_/ /_/_/  \____/     /_/   \___/____/\__/  )");
-    logger.info("");
-    logger.info("  Author: VincentZyu");
-    logger.info("  GitHub Profile: https://github.com/VincentZyu233");
-    logger.info("  GitHub Repo: https://github.com/VincentZyu233/levilamina-plugin-serverinfo-rest");
-    logger.info("");
+    LOG_INFO(logger, "");
+    LOG_INFO(logger, R"(                                   _       ____                           __)");
+    LOG_INFO(logger, R"(   ________  ______   _____  _____(_)___  / __/___        ________  _____/ /_)");
+    LOG_INFO(logger, R"(  / ___/ _ \/ ___/ | / / _ \/ ___/ / __ \/ /_/ __ \______/ ___/ _ \/ ___/ __/)");
+    LOG_INFO(logger, R"( (__  )  __/ /   | |/ /  __/ /  / / / / / __/ /_/ /_____/ /  /  __(__  ) /_  )");
+    LOG_INFO(logger, R"(/____/\___/_/    |___/\___/_/  /_/_/ /_/_/  \____/     /_/   \___/____/\__/  )");
+    LOG_INFO(logger, "");
+    LOG_INFO(logger, "  Author: VincentZyu");
+    LOG_INFO(logger, "  GitHub Profile: https://github.com/VincentZyu233");
+    LOG_INFO(logger, "  GitHub Repo: https://github.com/VincentZyu233/levilamina-plugin-serverinfo-rest");
+    LOG_INFO(logger, "");
 
     // 读取配置文件
     const auto& configFilePath = getSelf().getConfigDir() / "config.json";
     if (!ll::config::loadConfig(mConfig, configFilePath)) {
-        logger.warn("Cannot load configurations from {}", configFilePath.string());
-        logger.info("Saving default configurations...");
+        LOG_WARN(logger, "Cannot load configurations from {}", configFilePath.string());
+        LOG_INFO(logger, "Saving default configurations...");
         if (!ll::config::saveConfig(mConfig, configFilePath)) {
-            logger.error("Failed to save default configurations!");
+            LOG_ERROR(logger, "Failed to save default configurations!");
         }
     }
 
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    mETagEpoch = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+
     // 设置日志级别
     ll::io::LogLevel logLevel = parseLogLevel(mConfig.logLevel);
     logger.setLevel(logLevel);
-    logger.info("Log level set to: {}", mConfig.logLevel);
+    logging::setLevel(logLevel);
+    LOG_INFO(logger, "Log level set to: {}", mConfig.logLevel);
 
     // 输出配置信息
-    logger.debug("Configuration loaded:");
-    logger.debug("  - host: {}", mConfig.host);
-    logger.debug("  - port: {}", mConfig.port);
-    logger.debug("  - enableCors: {}", mConfig.enableCors);
-    logger.debug("  - apiPrefix: {}", mConfig.apiPrefix);
-    logger.debug("  - enableToken: {}", mConfig.enableToken);
+    LOG_DEBUG(logger, "Configuration loaded:");
+    LOG_DEBUG(logger, "  - host: {}", mConfig.host);
+    LOG_DEBUG(logger, "  - port: {}", mConfig.port);
+    LOG_DEBUG(logger, "  - enableCors: {}", mConfig.enableCors);
+    LOG_DEBUG(logger, "  - apiPrefix: {}", mConfig.apiPrefix);
+    LOG_DEBUG(logger, "  - enableToken: {}", mConfig.enableToken);
+    LOG_DEBUG(logger, "  - workerThreads: {}", mConfig.workerThreads);
+    LOG_DEBUG(logger, "  - workerQueueSize: {}", mConfig.workerQueueSize);
+    LOG_DEBUG(logger, "  - maxConnections: {}", mConfig.maxConnections);
+    LOG_DEBUG(logger, "  - acceptBacklog: {}", mConfig.acceptBacklog);
+    LOG_DEBUG(logger, "  - enableKeepAlive: {}", mConfig.enableKeepAlive);
+    LOG_DEBUG(logger, "  - keepAliveTimeout: {}ms", mConfig.keepAliveTimeout);
+    LOG_DEBUG(logger, "  - keepAliveMaxRequests: {}", mConfig.keepAliveMaxRequests);
+    LOG_DEBUG(logger, "  - headerTimeout: {}ms", mConfig.headerTimeout);
+    LOG_DEBUG(logger, "  - bodyTimeout: {}ms", mConfig.bodyTimeout);
+    LOG_DEBUG(logger, "  - writeTimeout: {}ms", mConfig.writeTimeout);
+    LOG_DEBUG(logger, "  - sseHistorySize: {}", mConfig.sseHistorySize);
+    LOG_DEBUG(logger, "  - sseMaxQueuedEvents: {}", mConfig.sseMaxQueuedEvents);
+    LOG_DEBUG(logger, "  - sseHeartbeatInterval: {}ms", mConfig.sseHeartbeatInterval);
+    LOG_DEBUG(logger, "  - sampleIntervalTicks: {}", mConfig.sampleIntervalTicks);
+    LOG_DEBUG(logger, "  - gameQueryTimeout: {}ms", mConfig.gameQueryTimeout);
+    LOG_DEBUG(logger, "  - gameQueryMaxPending: {}", mConfig.gameQueryMaxPending);
+    LOG_DEBUG(logger, "  - wsPingInterval: {}ms", mConfig.wsPingInterval);
+    LOG_DEBUG(logger, "  - wsSendBufferLimit: {}", mConfig.wsSendBufferLimit);
+    LOG_DEBUG(logger, "  - enableCompression: {}", mConfig.enableCompression);
+    LOG_DEBUG(logger, "  - compressionMinSize: {}", mConfig.compressionMinSize);
+    LOG_DEBUG(logger, "  - enableBinaryFormats: {}", mConfig.enableBinaryFormats);
+    LOG_DEBUG(logger, "  - batchMaxRequests: {}", mConfig.batchMaxRequests);
+    LOG_DEBUG(logger, "  - enableRateLimit: {}", mConfig.enableRateLimit);
+    LOG_DEBUG(logger, "  - rateLimitPerIp: {}", mConfig.rateLimitPerIp);
+    LOG_DEBUG(logger, "  - rateLimitIpBurst: {}", mConfig.rateLimitIpBurst);
+    LOG_DEBUG(logger, "  - rateLimitPerToken: {}", mConfig.rateLimitPerToken);
+    LOG_DEBUG(logger, "  - rateLimitTokenBurst: {}", mConfig.rateLimitTokenBurst);
+    LOG_DEBUG(logger, "  - rateLimitMaxClients: {}", mConfig.rateLimitMaxClients);
+    LOG_DEBUG(logger, "  - rateLimitIdleTimeout: {}ms", mConfig.rateLimitIdleTimeout);
+    LOG_DEBUG(logger, "  - enableDebugStats: {}", mConfig.enableDebugStats);
+    LOG_DEBUG(logger, "  - asyncLogging: {}", mConfig.asyncLogging);
+    LOG_DEBUG(logger, "  - asyncLogQueueSize: {}", mConfig.asyncLogQueueSize);
     if (mConfig.enableToken) {
-        logger.info("Token authentication is ENABLED");
+        LOG_INFO(logger, "Token authentication is ENABLED");
         if (mConfig.token.empty()) {
-            logger.warn("Token is empty! Please set a token in config.json");
+            LOG_WARN(logger, "Token is empty! Please set a token in config.json");
         }
     }
 
-    logger.info("serverinfo-rest loaded successfully!");
+    LOG_INFO(logger, "serverinfo-rest loaded successfully!");
     return true;
 }
 
 bool ServerInfoRestMod::enable() {
     auto& logger = getSelf().getLogger();
-    logger.info("Enabling serverinfo-rest...");
+    LOG_INFO(logger, "Enabling serverinfo-rest...");
+
+    // 异步日志: 请求线程和游戏线程只把消息写入队列，由后台线程输出
+    if (mConfig.asyncLogging) {
+        logging::startAsync(static_cast<size_t>(std::max(64, mConfig.asyncLogQueueSize)));
+        LOG_DEBUG(logger, "Async logging enabled (queue size: {})", mConfig.asyncLogQueueSize);
+    }
 
     // ==================== 注册玩家事件监听器 ====================
     auto& eventBus = ll::event::EventBus::getInstance();
 
     // 玩家加入事件
-    logger.debug("Registering PlayerJoinEvent listener...");
+    LOG_DEBUG(logger, "Registering PlayerJoinEvent listener...");
     mPlayerJoinListener = eventBus.emplaceListener<ll::event::player::PlayerJoinEvent>(
         [this](ll::event::player::PlayerJoinEvent& event) {
-            getSelf().getLogger().trace("[Event] PlayerJoinEvent triggered");
+            LOG_TRACE(getSelf().getLogger(), "[Event] PlayerJoinEvent triggered");
             auto& player = event.self();
             CachedPlayerInfo info;
             info.name = player.getRealName();
@@ -174,68 +751,56 @@ bool ServerInfoRestMod::enable() {
             info.posY = pos.y;
             info.posZ = pos.z;
             
-            getSelf().getLogger().trace("[Event] Extracted player info for: {}", info.name);
+            LOG_TRACE(getSelf().getLogger(), "[Event] Extracted player info for: {}", info.name);
             onPlayerJoin(info.xuid, info);
         }
     );
-    logger.info("PlayerJoinEvent listener registered successfully");
+    LOG_INFO(logger, "PlayerJoinEvent listener registered successfully");
 
     // 玩家离开事件
-    logger.debug("Registering PlayerDisconnectEvent listener...");
+    LOG_DEBUG(logger, "Registering PlayerDisconnectEvent listener...");
     mPlayerLeaveListener = eventBus.emplaceListener<ll::event::player::PlayerDisconnectEvent>(
         [this](ll::event::player::PlayerDisconnectEvent& event) {
-            getSelf().getLogger().trace("[Event] PlayerDisconnectEvent triggered");
+            LOG_TRACE(getSelf().getLogger(), "[Event] PlayerDisconnectEvent triggered");
             auto& player = event.self();
-            getSelf().getLogger().trace("[Event] Player disconnecting: {}", player.getRealName());
+            LOG_TRACE(getSelf().getLogger(), "[Event] Player disconnecting: {}", player.getRealName());
             onPlayerLeave(player.getXuid());
         }
     );
-    logger.info("PlayerDisconnectEvent listener registered successfully");
+    LOG_INFO(logger, "PlayerDisconnectEvent listener registered successfully");
+
+    // ==================== 启动游戏刻定时任务 (采样 / 历史数据) ====================
+    // 游戏线程查询由下面的刻任务每刻执行一批
+    mGameQueries = std::make_shared<GameQueryExecutor>(static_cast<size_t>(std::max(1, mConfig.gameQueryMaxPending)));
+    mRecordedJoins = mJoinCount.load();
+    mRecordedLeaves = mLeaveCount.load();
+    startTickTasks();
 
     // ==================== 创建 HTTP 服务器 ====================
     mHttpServer = std::make_unique<HttpServer>(mConfig.host, mConfig.port, this);
-    
-    if (!mHttpServer->start()) {
-        logger.error("Failed to start HTTP server!");
-        return false;
-    }
 
     std::string prefix = mConfig.apiPrefix;
 
     // Token 验证辅助函数
     auto validateToken = [this](const HttpRequest& req, HttpResponse& res) -> bool {
-        if (!mConfig.enableToken) {
-            return true; // 未启用 token 验证，直接通过
+        if (!mConfig.enableToken || tBatchContext) {
+            return true; // 未启用 token 验证，或者是已经验证过的 /batch 子请求
         }
         
-        // 从 query string 中提取 token
-        std::string reqToken;
-        std::istringstream queryStream(req.query);
-        std::string param;
-        
-        while (std::getline(queryStream, param, '&')) {
-            size_t eqPos = param.find('=');
-            if (eqPos != std::string::npos) {
-                std::string key = param.substr(0, eqPos);
-                std::string value = param.substr(eqPos + 1);
-                if (key == "token") {
-                    reqToken = value;
-                    break;
-                }
-            }
-        }
+        // query 参数已由解析器解码
+        std::string_view reqToken = req.getParam("token");
         
         if (reqToken.empty()) {
             res.setStatus(401, "Unauthorized");
             res.setJson("{\"error\": \"Missing token parameter\"}");
-            getSelf().getLogger().debug("Request rejected: missing token");
+            LOG_DEBUG(getSelf().getLogger(), "Request rejected: missing token");
             return false;
         }
         
         if (reqToken != mConfig.token) {
             res.setStatus(403, "Forbidden");
             res.setJson("{\"error\": \"Invalid token\"}");
-            getSelf().getLogger().debug("Request rejected: invalid token");
+            LOG_DEBUG(getSelf().getLogger(), "Request rejected: invalid token");
             return false;
         }
         
@@ -246,151 +811,311 @@ bool ServerInfoRestMod::enable() {
 
     // GET /api/v1/status - 服务器状态
     mHttpServer->get(prefix + "/status", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /status endpoint called");
+        LOG_TRACE(getSelf().getLogger(), "[API] /status endpoint called");
         if (!validateToken(req, res)) return;
         
-        nlohmann::json json;
-        json["status"] = "online";
-        json["plugin"] = "serverinfo-rest";
-        json["version"] = "1.0.0";
-        json["playerCount"] = getPlayerCount();
-        
-        getSelf().getLogger().debug("[API] /status response: playerCount={}", json["playerCount"].get<int>());
-        res.setJson(json.dump());
+        auto snapshot = getPlayerSnapshot();
+        if (applyETag(req, res, makeETag(snapshot->generation, "/status"))) return;
+        res.setJson(getCachedResponse(CachedResponse::Status, *snapshot));
     });
 
-    // GET /api/v1/players - 获取玩家列表
+    // GET /api/v1/players?fields=&op=&locale=&limit=&cursor= - 获取玩家列表
     mHttpServer->get(prefix + "/players", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /players endpoint called");
+        LOG_TRACE(getSelf().getLogger(), "[API] /players endpoint called");
         if (!validateToken(req, res)) return;
         
-        nlohmann::json json;
-        json["players"] = nlohmann::json::array();
-        
-        auto players = getPlayerCache();
-        getSelf().getLogger().debug("[API] /players fetching {} players from cache", players.size());
-        for (const auto& player : players) {
-            nlohmann::json playerJson;
-            playerJson["name"] = player.name;
-            playerJson["xuid"] = player.xuid;
-            playerJson["uuid"] = player.uuid;
-            json["players"].push_back(playerJson);
-            getSelf().getLogger().trace("[API] /players including: {}", player.name);
+        // 带查询参数时按需生成，否则使用缓存的完整列表
+        for (const char* param : {"fields", "op", "locale", "limit", "cursor"}) {
+            if (!req.getParam(param).empty()) {
+                queryPlayers(req, res);
+                return;
+            }
         }
-        
-        json["count"] = players.size();
-        getSelf().getLogger().debug("[API] /players response: count={}", players.size());
-        res.setJson(json.dump());
+        auto snapshot = getPlayerSnapshot();
+        if (applyETag(req, res, makeETag(snapshot->generation, "/players"))) return;
+        res.setJson(getCachedResponse(CachedResponse::Players, *snapshot));
     });
 
-    // GET /api/v1/players/count - 获取玩家数量
+    // GET /api/v1/players/count - 获取玩家数量 (高优先级，在事件循环中直接处理)
     mHttpServer->get(prefix + "/players/count", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /players/count endpoint called");
+        LOG_TRACE(getSelf().getLogger(), "[API] /players/count endpoint called");
         if (!validateToken(req, res)) return;
         
-        nlohmann::json json;
-        int count = getPlayerCount();
-        json["count"] = count;
-        
-        getSelf().getLogger().debug("[API] /players/count response: {}", count);
-        res.setJson(json.dump());
-    });
+        auto snapshot = getPlayerSnapshot();
+        if (applyETag(req, res, makeETag(snapshot->generation, "/players/count"))) return;
+        res.setJson(getCachedResponse(CachedResponse::PlayerCount, *snapshot));
+    }, RoutePriority::High);
 
     // GET /api/v1/players/names - 获取玩家名列表
     mHttpServer->get(prefix + "/players/names", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /players/names endpoint called");
+        LOG_TRACE(getSelf().getLogger(), "[API] /players/names endpoint called");
         if (!validateToken(req, res)) return;
         
-        nlohmann::json json;
-        json["names"] = nlohmann::json::array();
+        auto snapshot = getPlayerSnapshot();
+        if (applyETag(req, res, makeETag(snapshot->generation, "/players/names"))) return;
+        res.setJson(getCachedResponse(CachedResponse::PlayerNames, *snapshot));
+    });
+
+    // GET /api/v1/players/search?prefix=xxx&limit=10 - 按名字前缀搜索玩家 (忽略大小写)
+    mHttpServer->get(prefix + "/players/search", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /players/search endpoint called");
+        if (!validateToken(req, res)) return;
         
-        auto players = getPlayerCache();
-        for (const auto& player : players) {
-            json["names"].push_back(player.name);
+        std::string_view namePrefix = req.getParam("prefix");
+        size_t limit = 10;
+        if (auto limitParam = req.getParam("limit"); !limitParam.empty()) {
+            auto [ptr, ec] = std::from_chars(limitParam.data(), limitParam.data() + limitParam.size(), limit);
+            if (ec != std::errc() || ptr != limitParam.data() + limitParam.size() || limit == 0) {
+                res.setStatus(400, "Bad Request");
+                res.setJson("{\"error\": \"Invalid 'limit' parameter\"}");
+                return;
+            }
+            limit = std::min<size_t>(limit, 100);
         }
         
-        json["count"] = players.size();
-        getSelf().getLogger().debug("[API] /players/names response: {} names", players.size());
-        res.setJson(json.dump());
+        auto snapshot = getPlayerSnapshot();
+        std::string etag = makeETag(snapshot->generation, "/players/search?" + foldName(namePrefix) + "&"
+                                                              + std::to_string(limit));
+        if (applyETag(req, res, etag)) return;
+        
+        auto matches = snapshot->searchByPrefix(namePrefix, limit);
+        using MatchedPlayer = const CachedPlayerInfo*;
+        PlayerListEnvelope<MatchedPlayer> envelope{matches, matches.size()};
+        std::string body = toJson<PlayerListJson<MatchedPlayer>>(envelope, 64 + matches.size() * 128);
+        
+        LOG_DEBUG(getSelf().getLogger(), "[API] /players/search prefix='{}' matched {} players", namePrefix,
+                  matches.size());
+        res.setJson(body);
     });
 
-    // GET /api/v1/player/{name} - 获取指定玩家信息
-    // 由于简单的路由系统不支持参数，我们使用 query string: /api/v1/player?name=xxx&token=xxx
-    mHttpServer->get(prefix + "/player", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        if (!validateToken(req, res)) return;
+    // 输出单个玩家的详细信息，lookupKey 用于区分 ETag
+    auto sendPlayer = [this](const HttpRequest& req, HttpResponse& res, const PlayerSnapshot& snapshot,
+                             const CachedPlayerInfo* player, const std::string& lookupKey) {
+        if (!player) {
+            LOG_DEBUG(getSelf().getLogger(), "[API] player not found: {}", lookupKey);
+            res.setStatus(404, "Not Found");
+            res.setJson("{\"error\": \"Player not found\"}");
+            return;
+        }
+        LOG_DEBUG(getSelf().getLogger(), "[API] found player: {} ({})", player->name, lookupKey);
         
-        // 解析 query string 获取 name
-        std::string playerName;
-        std::istringstream queryStream(req.query);
-        std::string param;
+        // 坐标等实时状态来自最近一次采样，ETag 同时随玩家列表和采样变化
+        auto samples = getPlayerSamples();
+        const PlayerSample* sample = samples ? samples->find(player->xuid) : nullptr;
+        std::string variant = lookupKey + "@" + std::to_string(samples ? samples->sequence : 0);
+        if (applyETag(req, res, makeETag(snapshot.generation, variant))) return;
         
-        while (std::getline(queryStream, param, '&')) {
-            size_t eqPos = param.find('=');
-            if (eqPos != std::string::npos) {
-                std::string key = param.substr(0, eqPos);
-                std::string value = param.substr(eqPos + 1);
-                if (key == "name") {
-                    playerName = value;
-                    break;
-                }
-            }
+        std::string body;
+        body.reserve(384);
+        JsonWriter json(body);
+        json.beginObject();
+        PlayerDetailJson::writeFields(json, *player);
+        if (sample) {
+            json.key("position").beginObject();
+            json.field("x", sample->posX).field("y", sample->posY).field("z", sample->posZ);
+            json.endObject();
+            json.field("dimension", sample->dimension);
+            json.field("health", sample->health);
+            json.field("maxHealth", sample->maxHealth);
+            json.field("ping", sample->ping);
+        } else {
+            // 加入后还没有被采样过，使用加入时的坐标
+            json.key("position").beginObject();
+            json.field("x", player->posX).field("y", player->posY).field("z", player->posZ);
+            json.endObject();
         }
+        json.endObject();
+        
+        res.setJson(body);
+    };
+    
+    // 按名字查找：精确匹配优先，失败时忽略大小写
+    auto findByName = [](const PlayerSnapshot& snapshot, std::string_view name) {
+        const CachedPlayerInfo* player = snapshot.findByName(name);
+        return player ? player : snapshot.findByNameIgnoreCase(name);
+    };
+
+    // GET /api/v1/player/{name} - 获取指定玩家信息 (名字需要 URL 编码)
+    mHttpServer->get(prefix + "/player/{name}", [this, validateToken, sendPlayer, findByName](const HttpRequest& req,
+                                                                                               HttpResponse& res) {
+        if (!validateToken(req, res)) return;
+        
+        std::string playerName = percentDecode(req.getPathParam("name"), false);
+        LOG_DEBUG(getSelf().getLogger(), "[API] /player/{{name}} querying player: {}", playerName);
+        auto snapshot = getPlayerSnapshot();
+        sendPlayer(req, res, *snapshot, findByName(*snapshot, playerName), "name:" + playerName);
+    });
+
+    // GET /api/v1/player?name=xxx - 兼容旧版的 query string 形式
+    mHttpServer->get(prefix + "/player", [this, validateToken, sendPlayer, findByName](const HttpRequest& req,
+                                                                                        HttpResponse& res) {
+        if (!validateToken(req, res)) return;
+        
+        std::string playerName(req.getParam("name"));
         
         if (playerName.empty()) {
-            getSelf().getLogger().debug("[API] /player request missing 'name' parameter");
+            LOG_DEBUG(getSelf().getLogger(), "[API] /player request missing 'name' parameter");
             res.setStatus(400, "Bad Request");
             res.setJson("{\"error\": \"Missing 'name' parameter\"}");
             return;
         }
         
-        getSelf().getLogger().debug("[API] /player querying player: {}", playerName);
-        auto playerOpt = getPlayerByName(playerName);
-        if (!playerOpt) {
-            getSelf().getLogger().debug("[API] /player player not found: {}", playerName);
-            res.setStatus(404, "Not Found");
-            res.setJson("{\"error\": \"Player not found\"}");
-            return;
-        }
-        getSelf().getLogger().debug("[API] /player found player: {}", playerName);
-        
-        const auto& player = *playerOpt;
-        nlohmann::json json;
-        json["name"] = player.name;
-        json["xuid"] = player.xuid;
-        json["uuid"] = player.uuid;
-        json["ipAndPort"] = player.ipAndPort;
-        json["locale"] = player.locale;
-        json["isOperator"] = player.isOperator;
-        json["position"]["x"] = player.posX;
-        json["position"]["y"] = player.posY;
-        json["position"]["z"] = player.posZ;
+        LOG_DEBUG(getSelf().getLogger(), "[API] /player querying player: {}", playerName);
+        auto snapshot = getPlayerSnapshot();
+        sendPlayer(req, res, *snapshot, findByName(*snapshot, playerName), "name:" + playerName);
+    });
+
+    // GET /api/v1/players/{xuid} - 按 xuid 获取玩家信息
+    mHttpServer->get(prefix + "/players/{xuid:int}", [this, validateToken, sendPlayer](const HttpRequest& req,
+                                                                                        HttpResponse& res) {
+        if (!validateToken(req, res)) return;
         
-        res.setJson(json.dump());
+        std::string xuid(req.getPathParam("xuid"));
+        LOG_DEBUG(getSelf().getLogger(), "[API] /players/{{xuid}} querying xuid: {}", xuid);
+        auto snapshot = getPlayerSnapshot();
+        sendPlayer(req, res, *snapshot, snapshot->findByXuid(xuid), "xuid:" + xuid);
     });
 
     // GET /api/v1/server - 服务器信息
     mHttpServer->get(prefix + "/server", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /server endpoint called");
+        LOG_TRACE(getSelf().getLogger(), "[API] /server endpoint called");
         if (!validateToken(req, res)) return;
+        auto snapshot = getPlayerSnapshot();
+        if (applyETag(req, res, makeETag(snapshot->generation, "/server"))) return;
         
-        nlohmann::json json;
-        json["levelName"] = "Unknown"; // Level 名称需要其他方式获取
-        json["playerCount"] = getPlayerCount();
-        json["status"] = "running";
+        // Level 只能在游戏线程访问，交给查询执行器 (同一刻内的并发请求只查询一次)
+        std::string levelName;
+        bool ok = queryGame("levelName", [] {
+            auto level = ll::service::getLevel();
+            return level ? std::string(level->getLevelData().getLevelName()) : std::string("Unknown");
+        }, res, levelName);
+        if (!ok) return;
+        ServerEnvelope server{levelName, snapshot->size(), "running"};
         
-        getSelf().getLogger().debug("[API] /server response: playerCount={}", json["playerCount"].get<int>());
-        res.setJson(json.dump());
+        LOG_DEBUG(getSelf().getLogger(), "[API] /server response: playerCount={}", server.playerCount);
+        res.setJson(toJson<ServerJson>(server));
     });
 
-    // GET /api/v1/health - 健康检查端点 (不需要 token，用于监控)
-    mHttpServer->get(prefix + "/health", [this](const HttpRequest&, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] /health endpoint called");
-        res.setJson("{\"status\": \"healthy\"}");
+    // POST /api/v1/batch - 一次往返执行多个 GET 请求，所有子请求读取同一个玩家快照
+    mHttpServer->post(prefix + "/batch", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /batch endpoint called");
+        if (!validateToken(req, res)) return;
+        runBatch(req, res);
     });
 
+    // GET /api/v1/events - 玩家加入/离开事件流 (Server-Sent Events)
+    mHttpServer->get(prefix + "/events", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /events endpoint called");
+        if (!validateToken(req, res)) return;
+        res.startEventStream();
+    });
+
+    // GET /api/v1/history?metric=players&from=&to=&step= - 指标历史数据
+    mHttpServer->get(prefix + "/history", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /history endpoint called");
+        if (!validateToken(req, res)) return;
+        
+        std::string_view metricName = req.getParam("metric");
+        size_t metric = 0;
+        while (metric < std::size(kHistoryMetricNames) && metricName != kHistoryMetricNames[metric]) metric++;
+        if (metric == std::size(kHistoryMetricNames)) {
+            nlohmann::json json;
+            json["error"] = "Missing or unknown 'metric' parameter";
+            json["metrics"] = kHistoryMetricNames;
+            res.setStatus(400, "Bad Request");
+            res.setJson(json.dump());
+            return;
+        }
+        
+        // from/to 为 Unix 秒，默认最近一小时；step 为秒，默认约 300 个点
+        auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+        int64_t to = now;
+        int64_t from = now - 3600;
+        int64_t step = 0;
+        for (auto [name, value] : {std::pair{"from", &from}, std::pair{"to", &to}, std::pair{"step", &step}}) {
+            std::string_view param = req.getParam(name);
+            if (param.empty()) continue;
+            auto [ptr, ec] = std::from_chars(param.data(), param.data() + param.size(), *value);
+            if (ec != std::errc() || ptr != param.data() + param.size()) {
+                res.setStatus(400, "Bad Request");
+                res.setJson("{\"error\": \"Invalid '" + std::string(name) + "' parameter\"}");
+                return;
+            }
+        }
+        // 超出保留时长的部分不可能有数据：先限制到 [now - 30 天, now]，之后的减法和步长计算不会溢出
+        from = std::clamp(from, now - TimeSeries::kMaxRetention, now);
+        to = std::clamp(to, now - TimeSeries::kMaxRetention, now);
+        if (step <= 0) {
+            step = std::max<int64_t>(1, (to - from) / 300);
+        }
+        step = std::min(step, TimeSeries::kMaxRetention);
+        
+        const auto& series = mHistory[metric];
+        std::vector<TimeSeriesPoint> points;
+        step = series.query(from, to, step, points);
+        
+        bool counter = series.kind() == TimeSeries::Kind::Counter;
+        std::string body;
+        body.reserve(128 + points.size() * 64);
+        JsonWriter json(body);
+        json.beginObject();
+        json.field("metric", kHistoryMetricNames[metric]);
+        json.field("kind", counter ? "counter" : "gauge");
+        json.field("from", from).field("to", to).field("step", step);
+        json.key("points").beginArray();
+        for (const auto& point : points) {
+            // counter 输出时间段内的总和，gauge 输出平均/最小/最大值
+            json.beginObject().field("t", point.time);
+            if (counter) {
+                json.field("value", point.sum);
+            } else {
+                json.field("value", point.average()).field("min", point.min).field("max", point.max);
+            }
+            json.endObject();
+        }
+        json.endArray().endObject();
+        LOG_DEBUG(getSelf().getLogger(), "[API] /history {} returned {} points (step: {}s)", metricName, points.size(),
+                  step);
+        res.setJson(body);
+    });
+
+    // GET /api/v1/ws - WebSocket 订阅 (players / positions / status 主题的增量推送)
+    mHttpServer->get(prefix + "/ws", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /ws endpoint called");
+        if (!validateToken(req, res)) return;
+        acceptWebSocket(req, res, std::make_shared<PlayerFeedSession>(*this));
+    });
+
+    // GET /metrics - Prometheus 文本格式指标
+    mHttpServer->get("/metrics", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /metrics endpoint called");
+        if (!validateToken(req, res)) return;
+        res.headers["Content-Type"] = "text/plain; version=0.0.4; charset=utf-8";
+        res.body = buildMetrics();
+    });
+
+    // GET /api/v1/debug/stats - 延迟分布 (仅在 enableDebugStats 时注册)
+    if (mConfig.enableDebugStats) {
+        mHttpServer->get(prefix + "/debug/stats", [this, validateToken](const HttpRequest& req, HttpResponse& res) {
+            LOG_TRACE(getSelf().getLogger(), "[API] /debug/stats endpoint called");
+            if (!validateToken(req, res)) return;
+            res.setJson(buildDebugStats());
+        });
+    }
+
+    // GET /api/v1/health - 健康检查端点 (不需要 token，用于监控；高优先级，工作线程繁忙时也能立即响应)
+    mHttpServer->get(prefix + "/health", [this](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] /health endpoint called");
+        if (applyETag(req, res, makeETag(0, "/health"))) return;
+        res.setJson("{\"status\": \"healthy\"}");
+    }, RoutePriority::High);
+
     // GET / - 根路径，返回 API 信息
-    mHttpServer->get("/", [this, &prefix](const HttpRequest&, HttpResponse& res) {
-        getSelf().getLogger().trace("[API] / (root) endpoint called");
+    mHttpServer->get("/", [this, prefix](const HttpRequest& req, HttpResponse& res) {
+        LOG_TRACE(getSelf().getLogger(), "[API] / (root) endpoint called");
+        if (applyETag(req, res, makeETag(0, "/"))) return;
         nlohmann::json json;
         json["name"] = "serverinfo-rest";
         json["version"] = "1.0.0";
@@ -402,59 +1127,85 @@ bool ServerInfoRestMod::enable() {
             {"GET " + prefix + "/players", "List all online players"},
             {"GET " + prefix + "/players/count", "Get online player count"},
             {"GET " + prefix + "/players/names", "Get list of player names"},
-            {"GET " + prefix + "/player?name=<name>", "Get specific player information"}
+            {"GET " + prefix + "/players/search?prefix=<prefix>&limit=<n>", "Search players by name prefix"},
+            {"GET " + prefix + "/player/{name}", "Get specific player information"},
+            {"GET " + prefix + "/player?name=<name>", "Get specific player information (query form)"},
+            {"GET " + prefix + "/players/{xuid}", "Get player information by xuid"},
+            {"POST " + prefix + "/batch", "Run several GET requests against one player snapshot"},
+            {"GET /metrics", "Prometheus metrics"},
+            {"GET " + prefix + "/history?metric=<metric>&from=<unix>&to=<unix>&step=<seconds>", "Metric history"},
+            {"GET " + prefix + "/events", "Stream player join/leave events (Server-Sent Events)"},
+            {"GET " + prefix + "/ws", "WebSocket feed with players/positions/status topics"}
         };
+        if (mConfig.enableDebugStats) {
+            json["endpoints"]["GET " + prefix + "/debug/stats"] = "Latency percentiles per phase and route";
+        }
         res.setJson(json.dump(2));
     });
 
-    logger.info("serverinfo-rest enabled successfully!");
-    logger.info("REST API available at http://{}:{}{}", mConfig.host, mConfig.port, prefix);
+    // 路由注册完毕后再启动，启动时路由表被冻结
+    if (!mHttpServer->start()) {
+        LOG_ERROR(logger, "Failed to start HTTP server!");
+        return false;
+    }
+
+    LOG_INFO(logger, "serverinfo-rest enabled successfully!");
+    LOG_INFO(logger, "REST API available at http://{}:{}{}", mConfig.host, mConfig.port, prefix);
     return true;
 }
 
 bool ServerInfoRestMod::disable() {
     auto& logger = getSelf().getLogger();
-    logger.info("Disabling serverinfo-rest...");
+    LOG_INFO(logger, "Disabling serverinfo-rest...");
+    
+    // 停止采样和历史记录协程 (下一次唤醒时退出)
+    stopTickTasks();
+    
+    // 拒绝新的游戏线程查询，正在等待的工作线程立即返回
+    if (mGameQueries) {
+        mGameQueries->shutdown();
+    }
     
     // 移除事件监听器
-    logger.debug("Removing event listeners...");
+    LOG_DEBUG(logger, "Removing event listeners...");
     auto& eventBus = ll::event::EventBus::getInstance();
     if (mPlayerJoinListener) {
         eventBus.removeListener(mPlayerJoinListener);
         mPlayerJoinListener = nullptr;
-        logger.debug("PlayerJoinEvent listener removed");
+        LOG_DEBUG(logger, "PlayerJoinEvent listener removed");
     }
     if (mPlayerLeaveListener) {
         eventBus.removeListener(mPlayerLeaveListener);
         mPlayerLeaveListener = nullptr;
-        logger.debug("PlayerDisconnectEvent listener removed");
+        LOG_DEBUG(logger, "PlayerDisconnectEvent listener removed");
     }
     
     // 清空玩家缓存
-    logger.debug("Clearing player cache...");
-    {
-        std::lock_guard<std::mutex> lock(mPlayerCacheMutex);
-        int cacheSize = static_cast<int>(mPlayerCache.size());
-        mPlayerCache.clear();
-        logger.debug("Player cache cleared ({} entries removed)", cacheSize);
-    }
+    LOG_DEBUG(logger, "Clearing player cache...");
+    size_t cacheSize = mPlayerCache.clear();
+    LOG_DEBUG(logger, "Player cache cleared ({} entries removed)", cacheSize);
     
     if (mHttpServer) {
-        logger.debug("Stopping HTTP server...");
+        LOG_DEBUG(logger, "Stopping HTTP server...");
         mHttpServer->stop();
         mHttpServer.reset();
-        logger.debug("HTTP server stopped and released");
+        LOG_DEBUG(logger, "HTTP server stopped and released");
     }
+    // 已投递的任务持有执行器的引用，执行时发现没有待处理的查询直接返回
+    mGameQueries.reset();
+    
+    LOG_INFO(logger, "serverinfo-rest disabled!");
     
-    logger.info("serverinfo-rest disabled!");
+    // 所有会写日志的线程都已停止，输出剩余的日志并切回同步输出
+    logging::stopAsync();
     return true;
 }
 
 bool ServerInfoRestMod::unload() {
     auto& logger = getSelf().getLogger();
-    logger.info("Unloading serverinfo-rest...");
-    logger.debug("Plugin resources released");
-    logger.info("serverinfo-rest unloaded successfully!");
+    LOG_INFO(logger, "Unloading serverinfo-rest...");
+    LOG_DEBUG(logger, "Plugin resources released");
+    LOG_INFO(logger, "serverinfo-rest unloaded successfully!");
     return true;
 }
 
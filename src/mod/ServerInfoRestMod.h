@@ -1,29 +1,45 @@
 #pragma once
 
+#include "mod/Compression.h"
 #include "mod/Config.h"
+#include "mod/GameQueryExecutor.h"
+#include "mod/PlayerCache.h"
+#include "mod/PlayerSampler.h"
+#include "mod/TimeSeries.h"
 
 #include "ll/api/mod/NativeMod.h"
 #include "ll/api/event/ListenerBase.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <optional>
 
 namespace serverinfo_rest {
 
 class HttpServer;
+struct HttpRequest;
+struct HttpResponse;
+
+// 可缓存的响应体 (内容只依赖玩家缓存)
+enum class CachedResponse {
+    Status,
+    Players,
+    PlayerNames,
+    PlayerCount,
+    Count_
+};
 
-// 缓存的玩家信息结构
-struct CachedPlayerInfo {
-    std::string name;
-    std::string xuid;
-    std::string uuid;
-    std::string ipAndPort;
-    std::string locale;
-    bool isOperator = false;
-    float posX = 0, posY = 0, posZ = 0;
+// 保留历史数据的指标
+enum class HistoryMetric {
+    Players,      // 在线人数 (gauge)
+    Joins,        // 加入人数 (counter)
+    Leaves,       // 离开人数 (counter)
+    TickInterval, // 平均每刻间隔，毫秒 (gauge)
+    Count_
 };
 
 class ServerInfoRestMod {
@@ -42,19 +58,89 @@ public:
     [[nodiscard]] const Config& getConfig() const { return mConfig; }
     [[nodiscard]] HttpServer* getHttpServer() const { return mHttpServer.get(); }
 
-    // 线程安全的玩家缓存访问
-    std::vector<CachedPlayerInfo> getPlayerCache() const;
-    std::optional<CachedPlayerInfo> getPlayerByName(const std::string& name) const;
+    // 线程安全的玩家缓存访问 (无锁，返回的快照在持有期间保持不变)；/batch 子请求中返回批次固定的快照
+    [[nodiscard]] std::shared_ptr<const PlayerSnapshot> getPlayerSnapshot() const;
+    // 按名字查找玩家，精确匹配失败时退回忽略大小写的匹配
+    std::shared_ptr<const CachedPlayerInfo> getPlayerByName(std::string_view name) const;
     int getPlayerCount() const;
+    
+    // 玩家缓存版本号，每次玩家加入/离开时递增
+    [[nodiscard]] uint64_t getPlayerCacheGeneration() const;
+    
+    // 最近一次游戏刻采样的玩家状态 (坐标、维度、血量、延迟)，尚未采样时为空；/batch 子请求中同样固定
+    [[nodiscard]] std::shared_ptr<const PlayerSampleFrame> getPlayerSamples() const;
+    // 采样序号，每次采样递增
+    [[nodiscard]] uint64_t getPlayerSampleSequence() const { return mSampler.sequence(); }
+    
+    // 指标的历史数据 (线程安全)
+    [[nodiscard]] const TimeSeries& getHistory(HistoryMetric metric) const {
+        return mHistory[static_cast<size_t>(metric)];
+    }
+    
+    // Prometheus 文本格式的指标
+    std::string buildMetrics() const;
+    
+    // 各处理阶段与各路由的延迟分布 (JSON)，未启用 enableDebugStats 时为空
+    std::string buildDebugStats() const;
+    
+    // 获取 snapshot 对应的预序列化响应体，每个版本号只构建一次；
+    // 调用方用同一个快照的版本号生成 ETag，保证 ETag 与响应体一致
+    std::shared_ptr<const EncodedBody> getCachedResponse(CachedResponse which, const PlayerSnapshot& snapshot) const;
+    
+    // 根据玩家缓存版本号生成强 ETag，variant 区分同一版本下的不同资源
+    std::string makeETag(uint64_t generation, std::string_view variant) const;
 
 private:
     ll::mod::NativeMod& mSelf;
     Config mConfig;
     std::unique_ptr<HttpServer> mHttpServer;
 
-    // 玩家缓存 (线程安全)
-    mutable std::mutex mPlayerCacheMutex;
-    std::unordered_map<std::string, CachedPlayerInfo> mPlayerCache; // key = xuid
+    // 玩家缓存 (线程安全，读者无锁)
+    PlayerCache mPlayerCache;
+    uint64_t mETagEpoch = 0; // 插件加载时间，避免重载后版本号从 0 开始导致 ETag 冲突
+
+    // 游戏刻定时任务 (协程持有同一个运行标志，插件禁用后自行退出)
+    std::shared_ptr<std::atomic<bool>> mTickTasksRunning;
+    void startTickTasks();
+    void stopTickTasks();
+
+    // 实时游戏数据查询 (工作线程提交，游戏线程每刻合并执行一次)
+    std::shared_ptr<GameQueryExecutor> mGameQueries;
+    // 在游戏线程中执行查询并等待结果 (工作线程调用)；排队已满、超时或查询失败时写入错误响应并返回 false
+    bool queryGame(const std::string& key, GameQueryFn query, HttpResponse& res, std::string& result) const;
+
+    // 游戏刻采样 (双缓冲，HTTP 线程只读前台缓冲区)
+    PlayerSampler mSampler;
+    void samplePlayers();
+
+    // 历史数据，每秒 (20 刻) 记录一次
+    std::array<TimeSeries, static_cast<size_t>(HistoryMetric::Count_)> mHistory{{
+        {TimeSeries::Kind::Gauge},
+        {TimeSeries::Kind::Counter},
+        {TimeSeries::Kind::Counter},
+        {TimeSeries::Kind::Gauge},
+    }};
+    std::atomic<uint64_t> mJoinCount{0};    // 累计加入次数 (事件回调中无锁自增)
+    std::atomic<uint64_t> mLeaveCount{0};   // 累计离开次数
+    uint64_t mRecordedJoins = 0;            // 上次记录历史时的累计值 (仅游戏线程)
+    uint64_t mRecordedLeaves = 0;
+    std::atomic<double> mTickIntervalMs{0}; // 最近 20 刻的平均每刻间隔 (墙钟时间，满速时为 50)
+    void recordHistory(double tickIntervalMs);
+
+    // 预序列化的响应体缓存
+    struct ResponseCacheEntry {
+        std::mutex mutex;
+        uint64_t generation = UINT64_MAX;
+        std::shared_ptr<const EncodedBody> body; // 压缩版本随响应体一起缓存，版本变化时一起丢弃
+    };
+    mutable std::array<ResponseCacheEntry, static_cast<size_t>(CachedResponse::Count_)> mResponseCache;
+    std::string buildResponseBody(CachedResponse which, const PlayerSnapshot& snapshot) const;
+
+    // 带 fields / op / locale / limit / cursor 参数的 /players 查询，不经过响应缓存
+    void queryPlayers(const HttpRequest& req, HttpResponse& res) const;
+
+    // POST /batch：在同一个快照上依次执行多个 GET 子请求
+    void runBatch(const HttpRequest& req, HttpResponse& res) const;
 
     // 事件监听器
     ll::event::ListenerPtr mPlayerJoinListener;
@@ -0,0 +1,114 @@
+#pragma once
+
+// 跨平台 socket 封装：Windows 使用 Winsock，其他平台使用 BSD socket
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace serverinfo_rest::net {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+using SockLen = int;
+inline constexpr Socket kInvalidSocket = INVALID_SOCKET;
+#else
+using Socket = int;
+using SockLen = socklen_t;
+inline constexpr Socket kInvalidSocket = -1;
+#endif
+
+// 初始化/清理网络库 (仅 Windows 需要 WSAStartup)
+inline bool startup(int& errorCode) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    errorCode = WSAStartup(MAKEWORD(2, 2), &wsaData);
+    return errorCode == 0;
+#else
+    errorCode = 0;
+    return true;
+#endif
+}
+
+inline void cleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+inline int lastError() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+inline void closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+inline bool setNonBlocking(Socket socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+inline void setNoDelay(Socket socket) {
+    int opt = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&opt), sizeof(opt));
+}
+
+// 非阻塞操作暂时无法完成 (需要等待下一次就绪事件)
+inline bool isWouldBlock(int error) {
+#ifdef _WIN32
+    return error == WSAEWOULDBLOCK;
+#else
+    return error == EAGAIN || error == EWOULDBLOCK;
+#endif
+}
+
+inline bool isInterrupted(int error) {
+#ifdef _WIN32
+    return error == WSAEINTR;
+#else
+    return error == EINTR;
+#endif
+}
+
+// send 的包装：Linux 下屏蔽 SIGPIPE，避免对端关闭时进程被信号终止
+inline int sendBytes(Socket socket, const char* data, size_t length) {
+#ifdef _WIN32
+    return send(socket, data, static_cast<int>(length), 0);
+#else
+    return static_cast<int>(::send(socket, data, length, MSG_NOSIGNAL));
+#endif
+}
+
+inline int recvBytes(Socket socket, char* data, size_t length) {
+#ifdef _WIN32
+    return recv(socket, data, static_cast<int>(length), 0);
+#else
+    return static_cast<int>(::recv(socket, data, length, 0));
+#endif
+}
+
+} // namespace serverinfo_rest::net
@@ -0,0 +1,71 @@
+#include "mod/ThreadPool.h"
+
+namespace serverinfo_rest {
+
+ThreadPool::ThreadPool(std::size_t threadCount, std::size_t queueCapacity)
+    : mQueueCapacity(queueCapacity == 0 ? 1 : queueCapacity) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    mWorkers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+bool ThreadPool::trySubmit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStopping || mQueue.size() >= mQueueCapacity) {
+            return false;
+        }
+        mQueue.push_back(std::move(task));
+    }
+    mCondition.notify_one();
+    return true;
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStopping) {
+            return;
+        }
+        mStopping = true;
+    }
+    mCondition.notify_all();
+
+    for (auto& worker : mWorkers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::size_t ThreadPool::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mQueue.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            // 停止时仍然把队列里剩余的任务执行完，保证已接受的连接都能被关闭
+            if (mQueue.empty()) {
+                return;
+            }
+            task = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace serverinfo_rest
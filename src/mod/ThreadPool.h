@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 有界工作线程池：任务队列满时 trySubmit 直接返回 false，由调用方决定如何拒绝
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    ThreadPool(std::size_t threadCount, std::size_t queueCapacity);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 非阻塞提交，队列已满或线程池已停止时返回 false
+    bool trySubmit(Task task);
+
+    // 停止接收新任务，执行完已排队的任务后回收所有线程
+    void shutdown();
+
+    [[nodiscard]] std::size_t threadCount() const { return mWorkers.size(); }
+    [[nodiscard]] std::size_t queueCapacity() const { return mQueueCapacity; }
+    [[nodiscard]] std::size_t pendingCount() const;
+
+private:
+    void workerLoop();
+
+    std::size_t mQueueCapacity;
+    std::vector<std::thread> mWorkers;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Task> mQueue;
+    bool mStopping = false;
+};
+
+} // namespace serverinfo_rest
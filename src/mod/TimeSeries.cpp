@@ -0,0 +1,102 @@
+#include "mod/TimeSeries.h"
+
+#include <algorithm>
+
+namespace serverinfo_rest {
+
+// 向下对齐到 step 的整数倍 (支持负数)
+static int64_t alignDown(int64_t value, int64_t step) {
+    int64_t remainder = value % step;
+    return remainder < 0 ? value - remainder - step : value - remainder;
+}
+
+TimeSeries::TimeSeries(Kind kind) : mKind(kind) {
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        mRings[r].resize(kResolutions[r].slots);
+    }
+}
+
+void TimeSeries::record(int64_t time, double value) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        int64_t index = alignDown(time, kResolutions[r].step) / kResolutions[r].step;
+        int64_t slots = static_cast<int64_t>(kResolutions[r].slots);
+        auto& bucket = mRings[r][static_cast<size_t>(((index % slots) + slots) % slots)];
+        if (bucket.index != index) {
+            // 桶里是上一轮的旧数据 (或从未使用)，直接覆盖
+            bucket = Bucket{index, value, value, value, 1};
+            continue;
+        }
+        bucket.sum += value;
+        bucket.min = std::min(bucket.min, value);
+        bucket.max = std::max(bucket.max, value);
+        bucket.count++;
+    }
+    mLatest = std::max(mLatest, time);
+}
+
+int64_t TimeSeries::query(int64_t from, int64_t to, int64_t step, std::vector<TimeSeriesPoint>& out) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (to < from) {
+        return step;
+    }
+
+    // 在能覆盖 from 的分辨率中，选桶宽不超过 step 的最粗的一个；都比 step 粗时选其中最细的
+    size_t chosen = kResolutions.size() - 1;
+    bool found = false;
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        const auto& resolution = kResolutions[r];
+        int64_t retention = resolution.step * static_cast<int64_t>(resolution.slots);
+        if (from < mLatest - retention) {
+            continue;
+        }
+        if (!found || resolution.step <= step) {
+            chosen = r;
+            found = true;
+        }
+    }
+
+    const auto& resolution = kResolutions[chosen];
+    const auto& ring = mRings[chosen];
+    int64_t slots = static_cast<int64_t>(resolution.slots);
+
+    // 超出保留时长或尚未到来的部分不可能有数据，先裁掉，保证遍历的桶数不超过环形数组大小
+    from = std::max(from, mLatest - resolution.step * slots + resolution.step);
+    to = std::min(to, mLatest);
+    if (to < from) {
+        return std::max(step, resolution.step);
+    }
+
+    // 步长取分辨率桶宽的整数倍，并限制输出点数；超过保留时长的步长没有意义，先截断，后面的取整和累加不会溢出
+    int64_t retention = resolution.step * slots;
+    step = std::clamp(step, resolution.step, retention);
+    int64_t minStep = (to - from) / static_cast<int64_t>(kMaxPoints) + 1;
+    step = std::max(step, minStep);
+    step = (step + resolution.step - 1) / resolution.step * resolution.step;
+    int64_t bucketsPerStep = step / resolution.step;
+
+    for (int64_t start = alignDown(from, step);; start += step) {
+        TimeSeriesPoint point;
+        point.time = start;
+        int64_t first = alignDown(start, resolution.step) / resolution.step;
+        for (int64_t index = first; index < first + bucketsPerStep; ++index) {
+            const auto& bucket = ring[static_cast<size_t>(((index % slots) + slots) % slots)];
+            if (bucket.index != index || bucket.count == 0) {
+                continue;
+            }
+            point.min = point.count ? std::min(point.min, bucket.min) : bucket.min;
+            point.max = point.count ? std::max(point.max, bucket.max) : bucket.max;
+            point.sum += bucket.sum;
+            point.count += bucket.count;
+        }
+        if (point.count > 0) {
+            out.push_back(point);
+        }
+        if (to - start < step) {
+            break;
+        }
+    }
+    return step;
+}
+
+} // namespace serverinfo_rest
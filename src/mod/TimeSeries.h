@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// 时间序列中一个时间段的聚合结果
+struct TimeSeriesPoint {
+    int64_t time = 0; // 时间段起点 (Unix 秒)
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+    uint32_t count = 0; // 时间段内的样本数
+
+    [[nodiscard]] double average() const { return count ? sum / count : 0; }
+};
+
+// 多分辨率的内存时间序列
+// 每个分辨率是一个固定大小的环形数组，样本到达时同时累加进所有分辨率对应的桶 (O(1))，
+// 查询时直接读取合适分辨率的桶，不需要扫描原始样本。
+class TimeSeries {
+public:
+    enum class Kind {
+        Gauge,   // 瞬时值 (如在线人数)，聚合为平均/最小/最大
+        Counter, // 增量 (如每秒加入人数)，聚合为总和
+    };
+
+    struct Resolution {
+        int64_t step;  // 桶宽度 (秒)
+        size_t slots;  // 桶数量，保留时长 = step * slots
+    };
+
+    // 1 秒 x 1 小时、1 分钟 x 24 小时、10 分钟 x 30 天
+    static constexpr std::array<Resolution, 3> kResolutions = {{{1, 3600}, {60, 1440}, {600, 4320}}};
+
+    // 最粗分辨率的保留时长 (秒)，更早的数据不可能查到
+    static constexpr int64_t kMaxRetention =
+        kResolutions.back().step * static_cast<int64_t>(kResolutions.back().slots);
+
+    // 单次查询最多返回的点数，超过时自动放大步长
+    static constexpr size_t kMaxPoints = 1000;
+
+    TimeSeries(Kind kind);
+
+    // 记录一个样本 (time 为 Unix 秒，通常单调递增)
+    void record(int64_t time, double value);
+
+    // 查询 [from, to] 内按 step 聚合的点 (没有样本的时间段不输出)
+    // 会选择能覆盖 from 的、不比 step 更细的分辨率；返回实际使用的步长 (是该分辨率桶宽的整数倍，
+    // 不超过该分辨率的保留时长)。任意 int64 参数都不会溢出，遍历的桶数不超过环形数组大小
+    int64_t query(int64_t from, int64_t to, int64_t step, std::vector<TimeSeriesPoint>& out) const;
+
+    [[nodiscard]] Kind kind() const { return mKind; }
+
+private:
+    struct Bucket {
+        int64_t index = -1; // time / step，用于判断环形数组中的桶是否过期
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        uint32_t count = 0;
+    };
+
+    Kind mKind;
+    mutable std::mutex mMutex;
+    std::array<std::vector<Bucket>, kResolutions.size()> mRings;
+    int64_t mLatest = 0; // 最新样本的时间
+};
+
+} // namespace serverinfo_rest
@@ -0,0 +1,126 @@
+#include "mod/TimerWheel.h"
+
+#include <algorithm>
+
+namespace serverinfo_rest {
+
+void TimerNode::cancel() {
+    if (!next) {
+        return;
+    }
+    prev->next = next;
+    next->prev = prev;
+    prev = nullptr;
+    next = nullptr;
+    mWheel->mCount--;
+    mWheel = nullptr;
+}
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, std::chrono::steady_clock::time_point start)
+    : mStart(start), mTick(std::max(tick, std::chrono::milliseconds(1))) {
+    for (auto& level : mSlots) {
+        for (auto& head : level) {
+            head.prev = &head;
+            head.next = &head;
+        }
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    // 时间轮先于节点销毁时，把剩余节点标记为未调度，节点析构时不再访问时间轮
+    for (auto& level : mSlots) {
+        for (auto& head : level) {
+            TimerLink* link = head.next;
+            while (link != &head) {
+                TimerLink* next = link->next;
+                auto* node = static_cast<TimerNode*>(link);
+                node->prev = nullptr;
+                node->next = nullptr;
+                node->mWheel = nullptr;
+                link = next;
+            }
+        }
+    }
+}
+
+void TimerWheel::place(TimerNode& node, uint64_t earliest) {
+    // 已经到期的节点放到 earliest；超出最高层范围的节点先放在最远的位置，转到时再重新分配
+    uint64_t expiry = std::max(node.mExpiry, earliest);
+    uint64_t delta = std::min(expiry - mCurrent, kMaxDelta);
+    expiry = mCurrent + delta;
+
+    size_t level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t(1) << (kLevelBits * (level + 1)))) {
+        level++;
+    }
+    TimerLink& head = mSlots[level][(expiry >> (kLevelBits * level)) & kSlotMask];
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+}
+
+void TimerWheel::schedule(TimerNode& node, std::chrono::steady_clock::time_point deadline) {
+    node.cancel();
+    auto offset = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - mStart);
+    node.mExpiry = offset.count() > 0 ? static_cast<uint64_t>((offset + mTick - std::chrono::milliseconds(1)) / mTick) : 0;
+    node.mWheel = this;
+    // 当前 tick 已经处理完，最早在下一个 tick 到期
+    place(node, mCurrent + 1);
+    mCount++;
+}
+
+void TimerWheel::cascade(size_t level) {
+    TimerLink& head = mSlots[level][(mCurrent >> (kLevelBits * level)) & kSlotMask];
+    TimerLink* link = head.next;
+    head.prev = &head;
+    head.next = &head;
+    while (link != &head) {
+        TimerLink* next = link->next;
+        // 级联发生在处理当前 tick 之前，恰好在当前 tick 到期的节点必须落入第 0 层的当前槽位
+        place(*static_cast<TimerNode*>(link), mCurrent);
+        link = next;
+    }
+}
+
+void TimerWheel::expireCurrent(std::vector<uint64_t>& expired) {
+    TimerLink& head = mSlots[0][mCurrent & kSlotMask];
+    TimerLink* link = head.next;
+    head.prev = &head;
+    head.next = &head;
+    while (link != &head) {
+        TimerLink* next = link->next;
+        auto* node = static_cast<TimerNode*>(link);
+        node->prev = nullptr;
+        node->next = nullptr;
+        node->mWheel = nullptr;
+        mCount--;
+        expired.push_back(node->tag);
+        link = next;
+    }
+}
+
+size_t TimerWheel::advance(std::chrono::steady_clock::time_point now, std::vector<uint64_t>& expired) {
+    auto offset = std::chrono::duration_cast<std::chrono::milliseconds>(now - mStart);
+    uint64_t target = offset.count() > 0 ? static_cast<uint64_t>(offset / mTick) : 0;
+    size_t before = expired.size();
+
+    while (mCurrent < target) {
+        // 时间轮为空时直接跳到目标 tick (例如长时间没有连接之后)
+        if (mCount == 0) {
+            mCurrent = target;
+            break;
+        }
+        mCurrent++;
+        // 从高层到低层：低层的槽位转完一圈时，把上一层当前槽位中的节点分配下来
+        for (size_t level = kLevels - 1; level > 0; --level) {
+            if ((mCurrent & ((uint64_t(1) << (kLevelBits * level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+        expireCurrent(expired);
+    }
+    return expired.size() - before;
+}
+
+} // namespace serverinfo_rest
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace serverinfo_rest {
+
+class TimerWheel;
+
+// 双向循环链表的挂钩，时间轮的每个槽位是一个哨兵
+struct TimerLink {
+    TimerLink* prev = nullptr;
+    TimerLink* next = nullptr;
+};
+
+// 定时器节点，嵌入在拥有者对象中 (侵入式链表，调度和取消都不分配内存)
+// 节点析构时自动从时间轮中移除，拥有者被销毁后不会留下悬空的定时器
+class TimerNode : private TimerLink {
+public:
+    TimerNode() = default;
+    ~TimerNode() { cancel(); }
+
+    TimerNode(const TimerNode&) = delete;
+    TimerNode& operator=(const TimerNode&) = delete;
+
+    // 取消调度，未调度时不做任何事
+    void cancel();
+    [[nodiscard]] bool scheduled() const { return next != nullptr; }
+
+    uint64_t tag = 0; // 由使用者设置，到期时交还给使用者以找到拥有者
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel* mWheel = nullptr;
+    uint64_t mExpiry = 0; // 到期的 tick
+};
+
+// 分层时间轮 (hierarchical timing wheel)
+// 4 层，每层 64 个槽位：第 0 层每个槽位对应一个 tick，第 n 层每个槽位对应 64^n 个 tick。
+// 调度和取消都是 O(1)；推进时只处理当前 tick 的槽位，低层转完一圈时把高层对应槽位中的节点
+// 重新分配到低层。到期时间向上取整到 tick，因此定时器不会提前触发，最多推迟一个 tick。
+// 不是线程安全的，只应在一个线程 (事件循环) 中使用。
+class TimerWheel {
+public:
+    TimerWheel(std::chrono::milliseconds tick, std::chrono::steady_clock::time_point start);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 在 deadline 时到期，已调度的节点会先被取消 (即重新调度)
+    void schedule(TimerNode& node, std::chrono::steady_clock::time_point deadline);
+
+    // 推进到 now，把到期节点移出时间轮并把它们的 tag 追加到 expired，返回到期的数量
+    size_t advance(std::chrono::steady_clock::time_point now, std::vector<uint64_t>& expired);
+
+    [[nodiscard]] size_t size() const { return mCount; }
+    [[nodiscard]] std::chrono::milliseconds tick() const { return mTick; }
+
+private:
+    friend class TimerNode;
+
+    static constexpr unsigned kLevelBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kLevelBits;
+    static constexpr size_t kLevels = 4;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr uint64_t kMaxDelta = (uint64_t(1) << (kLevelBits * kLevels)) - 1;
+
+    void place(TimerNode& node, uint64_t earliest);
+    void cascade(size_t level);
+    void expireCurrent(std::vector<uint64_t>& expired);
+
+    std::chrono::steady_clock::time_point mStart;
+    std::chrono::milliseconds mTick;
+    uint64_t mCurrent = 0; // 已经处理完的 tick
+    size_t mCount = 0;
+    std::array<std::array<TimerLink, kSlots>, kLevels> mSlots;
+};
+
+} // namespace serverinfo_rest
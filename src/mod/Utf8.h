@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace serverinfo_rest {
+
+namespace utf8_detail {
+
+// 检查从 text[pos] 开始的序列，返回其中合法的字节数 (最长合法前缀)，expected 为首字节要求的总长度
+// 首字节不合法时 expected 为 0
+inline size_t validPrefix(std::string_view text, size_t pos, size_t& expected) {
+    auto byte = [&](size_t offset) { return static_cast<uint8_t>(text[pos + offset]); };
+    uint8_t lead = byte(0);
+    if (lead < 0x80) {
+        expected = 1;
+        return 1;
+    }
+
+    uint8_t low = 0x80; // 第二个字节的范围，排除过长编码、代理区和超出范围的码点
+    uint8_t high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        expected = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        expected = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        expected = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        expected = 0;
+        return 0;
+    }
+
+    size_t available = text.size() - pos;
+    if (available < 2 || byte(1) < low || byte(1) > high) return 1;
+    size_t length = 2;
+    while (length < expected && length < available && (byte(length) & 0xC0) == 0x80) {
+        length++;
+    }
+    return length;
+}
+
+} // namespace utf8_detail
+
+// 返回从 text[pos] 开始的一个合法 UTF-8 序列的字节数 (RFC 3629)；
+// 过长编码、代理区 (U+D800 ~ U+DFFF)、超出 U+10FFFF 或被截断的序列返回 0
+inline size_t utf8SequenceLength(std::string_view text, size_t pos) {
+    size_t expected = 0;
+    size_t length = utf8_detail::validPrefix(text, pos, expected);
+    return length == expected ? length : 0;
+}
+
+// 不合法的序列中应当整体替换为一个 U+FFFD 的字节数 (至少 1 个)：
+// 按 Unicode 推荐的做法取最长合法前缀，例如被截断的三字节字符只替换一次
+inline size_t utf8InvalidLength(std::string_view text, size_t pos) {
+    size_t expected = 0;
+    size_t length = utf8_detail::validPrefix(text, pos, expected);
+    return length > 0 ? length : 1;
+}
+
+// 整个字符串是否是合法的 UTF-8
+inline bool isValidUtf8(std::string_view text) {
+    for (size_t pos = 0; pos < text.size();) {
+        size_t length = utf8SequenceLength(text, pos);
+        if (length == 0) return false;
+        pos += length;
+    }
+    return true;
+}
+
+} // namespace serverinfo_rest
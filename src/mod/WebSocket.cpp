@@ -0,0 +1,257 @@
+#include "mod/WebSocket.h"
+#include "mod/Utf8.h"
+
+#include <array>
+
+namespace serverinfo_rest {
+
+namespace {
+
+// 握手只需要对很短的字符串做一次 SHA-1，没必要引入加密库
+std::array<uint8_t, 20> sha1(std::string_view input) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    auto rotl = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+
+    // 填充: 0x80，补零到 56 (mod 64)，最后 8 字节是大端序的位长度
+    std::string message(input);
+    uint64_t bitLength = static_cast<uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int i = 7; i >= 0; --i) {
+        message.push_back(static_cast<char>((bitLength >> (i * 8)) & 0xFF));
+    }
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const uint8_t*>(message.data() + chunk + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest{};
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+    return digest;
+}
+
+std::string base64Encode(const uint8_t* data, size_t size) {
+    static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t triple = uint32_t(data[i]) << 16;
+        if (i + 1 < size) triple |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) triple |= uint32_t(data[i + 2]);
+        out.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? kAlphabet[(triple >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? kAlphabet[triple & 0x3F] : '=');
+    }
+    return out;
+}
+
+bool isControl(WebSocketOpcode opcode) {
+    return (static_cast<uint8_t>(opcode) & 0x8) != 0;
+}
+
+// 关闭帧中允许出现的状态码 (RFC 6455 7.4)：1004 保留，1005 / 1006 / 1015 只用于本地报告，不能发送
+bool isValidCloseCode(uint16_t code) {
+    if (code >= 3000 && code <= 4999) return true;
+    return code >= 1000 && code <= 1014 && code != 1004 && code != 1005 && code != 1006;
+}
+
+} // namespace
+
+std::string computeWebSocketAccept(std::string_view key) {
+    std::string input(key);
+    input += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    auto digest = sha1(input);
+    return base64Encode(digest.data(), digest.size());
+}
+
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, std::string_view payload) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame.push_back(static_cast<char>(0x80 | static_cast<uint8_t>(opcode))); // FIN + opcode
+
+    uint64_t length = payload.size();
+    if (length < 126) {
+        frame.push_back(static_cast<char>(length));
+    } else if (length <= 0xFFFF) {
+        frame.push_back(static_cast<char>(126));
+        frame.push_back(static_cast<char>((length >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(length & 0xFF));
+    } else {
+        frame.push_back(static_cast<char>(127));
+        for (int i = 7; i >= 0; --i) {
+            frame.push_back(static_cast<char>((length >> (i * 8)) & 0xFF));
+        }
+    }
+    frame += payload;
+    return frame;
+}
+
+std::string encodeWebSocketClose(uint16_t code) {
+    char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+    return encodeWebSocketFrame(WebSocketOpcode::Close, std::string_view(payload, 2));
+}
+
+WebSocketReader::Result WebSocketReader::read(std::string_view data, WebSocketFrame& frame) {
+    mConsumed = 0;
+
+    // 一次可能跳过若干个中间分片，直到得到完整消息、控制帧或数据不足
+    while (true) {
+        std::string_view rest = data.substr(mConsumed);
+        if (rest.size() < 2) {
+            return Result::Incomplete;
+        }
+
+        auto b0 = static_cast<uint8_t>(rest[0]);
+        auto b1 = static_cast<uint8_t>(rest[1]);
+        bool fin = (b0 & 0x80) != 0;
+        auto opcode = static_cast<WebSocketOpcode>(b0 & 0x0F);
+
+        // 未协商扩展，RSV 位必须为 0；客户端帧必须加掩码
+        if ((b0 & 0x70) != 0 || (b1 & 0x80) == 0) {
+            return fail(ws_close::ProtocolError);
+        }
+
+        size_t headerSize = 2;
+        uint64_t length = b1 & 0x7F;
+        if (length == 126) {
+            if (rest.size() < 4) return Result::Incomplete;
+            length = (uint64_t(uint8_t(rest[2])) << 8) | uint8_t(rest[3]);
+            headerSize = 4;
+        } else if (length == 127) {
+            if (rest.size() < 10) return Result::Incomplete;
+            length = 0;
+            for (int i = 0; i < 8; ++i) {
+                length = (length << 8) | uint8_t(rest[2 + i]);
+            }
+            headerSize = 10;
+        }
+
+        if (isControl(opcode)) {
+            // 控制帧不能分片，长度不超过 125
+            if (!fin || length > 125) {
+                return fail(ws_close::ProtocolError);
+            }
+        } else if (length > mMaxMessageSize || mFragments.size() + length > mMaxMessageSize) {
+            return fail(ws_close::MessageTooBig);
+        }
+
+        size_t frameSize = headerSize + 4 + static_cast<size_t>(length);
+        if (rest.size() < frameSize) {
+            return Result::Incomplete;
+        }
+
+        const char* mask = rest.data() + headerSize;
+        std::string_view masked = rest.substr(headerSize + 4, static_cast<size_t>(length));
+        std::string payload(masked);
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+        }
+        mConsumed += frameSize;
+
+        switch (opcode) {
+        case WebSocketOpcode::Close:
+            // 负载为空，或者是 2 字节状态码加上 UTF-8 原因
+            if (!payload.empty()) {
+                if (payload.size() < 2) {
+                    return fail(ws_close::ProtocolError);
+                }
+                auto code = static_cast<uint16_t>((uint8_t(payload[0]) << 8) | uint8_t(payload[1]));
+                if (!isValidCloseCode(code)) {
+                    return fail(ws_close::ProtocolError);
+                }
+                if (!isValidUtf8(std::string_view(payload).substr(2))) {
+                    return fail(ws_close::InvalidPayload);
+                }
+            }
+            [[fallthrough]];
+        case WebSocketOpcode::Ping:
+        case WebSocketOpcode::Pong:
+            frame.opcode = opcode;
+            frame.payload = std::move(payload);
+            return Result::Frame;
+        case WebSocketOpcode::Text:
+        case WebSocketOpcode::Binary:
+            if (mFragmented) {
+                return fail(ws_close::ProtocolError);
+            }
+            if (fin) {
+                if (opcode == WebSocketOpcode::Text && !isValidUtf8(payload)) {
+                    return fail(ws_close::InvalidPayload);
+                }
+                frame.opcode = opcode;
+                frame.payload = std::move(payload);
+                return Result::Frame;
+            }
+            mFragmented = true;
+            mFragmentOpcode = opcode;
+            mFragments = std::move(payload);
+            break;
+        case WebSocketOpcode::Continuation:
+            if (!mFragmented) {
+                return fail(ws_close::ProtocolError);
+            }
+            mFragments += payload;
+            if (fin) {
+                // 多字节字符可能跨越分片，收齐后再校验
+                if (mFragmentOpcode == WebSocketOpcode::Text && !isValidUtf8(mFragments)) {
+                    return fail(ws_close::InvalidPayload);
+                }
+                frame.opcode = mFragmentOpcode;
+                frame.payload = std::move(mFragments);
+                mFragments.clear();
+                mFragmented = false;
+                return Result::Frame;
+            }
+            break;
+        default:
+            return fail(ws_close::ProtocolError);
+        }
+    }
+}
+
+} // namespace serverinfo_rest
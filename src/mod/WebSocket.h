@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace serverinfo_rest {
+
+// RFC 6455 帧类型
+enum class WebSocketOpcode : uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA,
+};
+
+// 常用的关闭状态码 (RFC 6455 7.4.1)
+namespace ws_close {
+constexpr uint16_t Normal = 1000;
+constexpr uint16_t GoingAway = 1001;
+constexpr uint16_t ProtocolError = 1002;
+constexpr uint16_t UnsupportedData = 1003;
+constexpr uint16_t InvalidPayload = 1007; // 文本消息或关闭原因不是合法的 UTF-8
+constexpr uint16_t PolicyViolation = 1008;
+constexpr uint16_t MessageTooBig = 1009;
+} // namespace ws_close
+
+// 解码后的一条完整消息 (分片已合并) 或一个控制帧
+struct WebSocketFrame {
+    WebSocketOpcode opcode = WebSocketOpcode::Text;
+    std::string payload;
+};
+
+// 根据客户端的 Sec-WebSocket-Key 计算 Sec-WebSocket-Accept
+std::string computeWebSocketAccept(std::string_view key);
+
+// 编码服务器发出的帧 (服务器帧不加掩码)
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, std::string_view payload);
+std::string encodeWebSocketClose(uint16_t code);
+
+// 增量式客户端帧解码器
+// 每次用连接缓冲区开头的数据调用 read()，调用后从缓冲区移除 consumed() 个字节；
+// 分片消息在内部拼接，只在收齐后作为一条消息返回。
+// 文本消息和关闭原因必须是合法的 UTF-8 (否则 1007)；关闭帧的状态码必须可以出现在线路上 (否则 1002)，
+// 因此返回的 Close 帧的负载要么为空，要么以合法的状态码开头。
+class WebSocketReader {
+public:
+    enum class Result { Incomplete, Frame, Error };
+
+    explicit WebSocketReader(size_t maxMessageSize = 64 * 1024) : mMaxMessageSize(maxMessageSize) {}
+
+    Result read(std::string_view data, WebSocketFrame& frame);
+
+    [[nodiscard]] size_t consumed() const { return mConsumed; }
+    [[nodiscard]] uint16_t errorCode() const { return mErrorCode; }
+
+private:
+    Result fail(uint16_t code) {
+        mErrorCode = code;
+        return Result::Error;
+    }
+
+    size_t mMaxMessageSize;
+    size_t mConsumed = 0;
+    uint16_t mErrorCode = 0;
+    bool mFragmented = false;
+    WebSocketOpcode mFragmentOpcode = WebSocketOpcode::Text;
+    std::string mFragments;
+};
+
+// 一个 WebSocket 连接上的应用层会话，所有回调都在事件循环线程中调用，
+// 要发送的文本消息追加到 out 中
+class WebSocketSession {
+public:
+    virtual ~WebSocketSession() = default;
+
+    // 握手完成后调用
+    virtual void onOpen(std::vector<std::string>& /*out*/) {}
+
+    // 收到一条完整的文本消息
+    virtual void onMessage(std::string_view text, std::vector<std::string>& out) = 0;
+
+    // 数据可能已变化、且发送缓冲区低于上限时调用，用于推送增量
+    virtual void onPoll(std::vector<std::string>& /*out*/) {}
+};
+
+} // namespace serverinfo_rest
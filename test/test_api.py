@@ -37,26 +37,42 @@ def print_section(emoji: str, title: str):
     print("-" * 40)
 
 
-def request_api(url: str, timeout: int = 10) -> tuple[int, dict | str | None]:
-    """发送 GET 请求并返回 (状态码, 响应内容)"""
+def send_request(url: str, timeout: int = 10, method: str = "GET", body: bytes | None = None,
+                 headers: dict | None = None) -> tuple[int, dict, dict | str | None]:
+    """发送请求并返回 (状态码, 响应头, 响应内容)，304 等非 2xx 状态同样返回"""
+    all_headers = {"User-Agent": "serverinfo-rest-tester/1.0"}
+    all_headers.update(headers or {})
     try:
-        req = Request(url, headers={"User-Agent": "serverinfo-rest-tester/1.0"})
+        req = Request(url, data=body, headers=all_headers, method=method)
         with urlopen(req, timeout=timeout) as response:
             content = response.read().decode("utf-8")
             try:
-                return response.status, json.loads(content)
+                return response.status, dict(response.headers), json.loads(content)
             except json.JSONDecodeError:
-                return response.status, content
+                return response.status, dict(response.headers), content
     except HTTPError as e:
+        response_headers = dict(e.headers or {})
         try:
             content = e.read().decode("utf-8")
-            return e.code, json.loads(content)
+            return e.code, response_headers, json.loads(content)
         except:
-            return e.code, str(e)
+            return e.code, response_headers, str(e)
     except URLError as e:
-        return 0, f"连接失败: {e.reason}"
+        return 0, {}, f"连接失败: {e.reason}"
     except Exception as e:
-        return 0, f"请求错误: {e}"
+        return 0, {}, f"请求错误: {e}"
+
+
+def request_api(url: str, timeout: int = 10) -> tuple[int, dict | str | None]:
+    """发送 GET 请求并返回 (状态码, 响应内容)"""
+    status, _, data = send_request(url, timeout)
+    return status, data
+
+
+def check(ok: bool, message: str) -> bool:
+    """打印单项检查结果"""
+    print(colored(f"  ✅ {message}", "green") if ok else colored(f"  ❌ {message}", "red"))
+    return ok
 
 
 def print_response(status: int, data):
@@ -161,6 +177,50 @@ def main():
         print_section("👤", f"[额外] 查询玩家: {args.player}")
         status, data = request_api(build_url(f"{api_base}/player", f"name={args.player}"), args.timeout)
         results.append((f"玩家 {args.player}", print_response(status, data)))
+        
+        print_section("🔍", f"[额外] 前缀搜索: {args.player[:3]}")
+        status, data = request_api(build_url(f"{api_base}/players/search", f"prefix={args.player[:3]}&limit=5"), args.timeout)
+        results.append((f"前缀搜索 {args.player[:3]}", print_response(status, data)))
+    
+    # 字段选择 + 分页
+    print_section("📄", "[额外] 玩家列表 (字段选择 + 分页)")
+    status, data = request_api(build_url(f"{api_base}/players", "fields=name,locale,position&limit=1"), args.timeout)
+    results.append(("玩家列表分页", print_response(status, data)))
+    
+    # 批量请求: 两个有效子请求 + 一个不存在的路径，每项有各自的状态码
+    print_section("📦", "[额外] 批量请求")
+    batch = {"requests": [f"{args.prefix}/status", {"path": f"{args.prefix}/players/count"}, f"{args.prefix}/no-such-endpoint"]}
+    status, _, data = send_request(build_url(f"{api_base}/batch"), args.timeout, "POST",
+                                   json.dumps(batch).encode("utf-8"), {"Content-Type": "application/json"})
+    ok = print_response(status, data)
+    if ok:
+        responses = data.get("responses", []) if isinstance(data, dict) else []
+        statuses = [item.get("status") for item in responses]
+        ok = check(statuses == [200, 200, 404], f"子请求状态码 {statuses} (期望 [200, 200, 404])")
+        ok = check(data.get("count") == 3, "count 等于子请求数") and ok
+    results.append(("批量请求", ok))
+    
+    # 条件请求: 带上一次的 ETag 再次请求，玩家列表没有变化时返回 304
+    print_section("🏷️ ", "[额外] 条件请求 (ETag)")
+    players_url = build_url(f"{api_base}/players")
+    status, headers, _ = send_request(players_url, args.timeout)
+    etag = headers.get("ETag")
+    ok = check(status == 200 and bool(etag), f"首次请求返回 ETag: {etag}")
+    if ok:
+        status, _, _ = send_request(players_url, args.timeout, headers={"If-None-Match": etag})
+        ok = check(status == 304, f"携带 If-None-Match 返回 {status} (期望 304)")
+    results.append(("条件请求", ok))
+    
+    # Prometheus 指标: 所有指标都以 serverinfo_ 开头
+    print_section("📈", "[额外] Prometheus 指标")
+    status, _, data = send_request(build_url(f"{base_url}/metrics"), args.timeout)
+    ok = check(status == 200 and isinstance(data, str), f"状态码 {status}")
+    if ok:
+        samples = [line for line in data.splitlines() if line and not line.startswith("#")]
+        print(f"指标数: {len(samples)}")
+        ok = check(bool(samples), "至少包含一个指标")
+        ok = check(all(line.startswith("serverinfo_") for line in samples), "指标名以 serverinfo_ 开头") and ok
+    results.append(("Prometheus 指标", ok))
     
     # 打印结果汇总
     print_header("📋 测试结果汇总")
@@ -0,0 +1,79 @@
+// BinaryFormat 单元测试：Accept 协商规则与 JSON 到 MessagePack / CBOR 的转换
+
+#include "mod/BinaryFormat.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+struct NegotiationCase {
+    const char* accept;
+    BodyFormat expected;
+};
+
+std::vector<uint8_t> bytes(const std::string& data) { return {data.begin(), data.end()}; }
+
+} // namespace
+
+// ==================== Accept 协商 ====================
+
+TEST(BinaryFormat, NegotiatesByQuality) {
+    const NegotiationCase cases[] = {
+        {"", BodyFormat::Json},
+        {"*/*", BodyFormat::Json},
+        {"application/*", BodyFormat::Json},
+        {"application/json", BodyFormat::Json},
+        {"application/msgpack", BodyFormat::MessagePack},
+        {"application/x-msgpack", BodyFormat::MessagePack},
+        {"Application/VND.MsgPack", BodyFormat::MessagePack},
+        {"application/cbor", BodyFormat::Cbor},
+        // q 值与 JSON 相同时二进制格式优先
+        {"application/json, application/msgpack", BodyFormat::MessagePack},
+        {"application/msgpack, application/json", BodyFormat::MessagePack},
+        {"application/cbor;q=0.5, application/json;q=0.5", BodyFormat::Cbor},
+        {"application/msgpack, */*", BodyFormat::MessagePack},
+        // JSON 的 q 值更高时不切换
+        {"application/json, application/msgpack;q=0.9", BodyFormat::Json},
+        {"*/*, application/cbor;q=0.8", BodyFormat::Json},
+        // 两种二进制格式：q 值高者优先，相同时选 MessagePack
+        {"application/cbor, application/msgpack;q=0.5", BodyFormat::Cbor},
+        {"application/cbor, application/msgpack", BodyFormat::MessagePack},
+        // q=0 表示不接受
+        {"application/msgpack;q=0", BodyFormat::Json},
+        {"application/json;q=0, application/cbor;q=0", BodyFormat::Json},
+        {"application/json;q=0, application/cbor;q=0.1", BodyFormat::Cbor},
+    };
+    for (const auto& testCase : cases) {
+        SCOPED_TRACE(testCase.accept);
+        EXPECT_EQ(negotiateBodyFormat(testCase.accept), testCase.expected);
+    }
+}
+
+// ==================== 转换 ====================
+
+TEST(BinaryFormat, TranscodesToMessagePack) {
+    std::string output;
+    ASSERT_TRUE(transcodeJson(R"({"a":[1,-1,true,null,"x"]})", BodyFormat::MessagePack, output));
+    const std::vector<uint8_t> expected = {0x81, 0xa1, 'a', 0x95, 0x01, 0xff, 0xc3, 0xc0, 0xa1, 'x'};
+    EXPECT_EQ(bytes(output), expected);
+}
+
+TEST(BinaryFormat, TranscodesToCbor) {
+    std::string output;
+    ASSERT_TRUE(transcodeJson(R"({"a":[1,-1,true,null,"x"]})", BodyFormat::Cbor, output));
+    const std::vector<uint8_t> expected = {0xa1, 0x61, 'a', 0x85, 0x01, 0x20, 0xf5, 0xf6, 0x61, 'x'};
+    EXPECT_EQ(bytes(output), expected);
+}
+
+TEST(BinaryFormat, RejectsInvalidJson) {
+    std::string output;
+    for (const char* json : {"", "{", "[1,]", "{\"a\" 1}", "tru", "\"unterminated"}) {
+        SCOPED_TRACE(json);
+        EXPECT_FALSE(transcodeJson(json, BodyFormat::MessagePack, output));
+    }
+}
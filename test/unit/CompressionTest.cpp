@@ -0,0 +1,127 @@
+// Compression 单元测试：Accept-Encoding 协商与 EncodedBody 的按需缓存
+
+#include "mod/Compression.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+struct NegotiationCase {
+    const char* acceptEncoding;
+    ContentEncoding expected;
+};
+
+std::string repetitiveJson() {
+    std::string json = "[";
+    for (int i = 0; i < 200; ++i) {
+        json += std::string(i ? "," : "") + "{\"name\":\"Steve\",\"locale\":\"en_US\",\"op\":false}";
+    }
+    return json + "]";
+}
+
+} // namespace
+
+// ==================== Accept-Encoding 协商 ====================
+
+TEST(Compression, NegotiatesEncoding) {
+    const NegotiationCase cases[] = {
+        {"", ContentEncoding::Identity},
+        {"identity", ContentEncoding::Identity},
+        {"gzip", ContentEncoding::Gzip},
+        {"deflate, gzip", ContentEncoding::Gzip},
+        {"gzip, deflate, br", ContentEncoding::Brotli},
+        {"br;q=0.5, gzip", ContentEncoding::Gzip},
+        {"GZIP;q=0", ContentEncoding::Identity},
+        {"*", ContentEncoding::Brotli},
+    };
+    for (const auto& testCase : cases) {
+        SCOPED_TRACE(testCase.acceptEncoding);
+        EXPECT_EQ(negotiateEncoding(testCase.acceptEncoding), testCase.expected);
+    }
+}
+
+TEST(Compression, EncodingTagsAreDistinct) {
+    // ETag 的编码后缀：未压缩时为空，各编码互不相同
+    EXPECT_TRUE(contentEncodingTag(ContentEncoding::Identity).empty());
+    EXPECT_EQ(contentEncodingTag(ContentEncoding::Gzip), "-gzip");
+    EXPECT_EQ(contentEncodingTag(ContentEncoding::Deflate), "-deflate");
+    EXPECT_EQ(contentEncodingTag(ContentEncoding::Brotli), "-br");
+}
+
+// ==================== EncodedBody ====================
+
+TEST(Compression, EncodedBodyCachesEachEncoding) {
+    EncodedBody body(repetitiveJson());
+    EXPECT_EQ(body.encoded(ContentEncoding::Identity), nullptr);
+    for (auto encoding : {ContentEncoding::Gzip, ContentEncoding::Deflate, ContentEncoding::Brotli}) {
+        SCOPED_TRACE(contentEncodingName(encoding));
+        auto first = body.encoded(encoding);
+        ASSERT_NE(first, nullptr);
+        EXPECT_LT(first->size(), body.identity().size());
+        EXPECT_EQ(body.encoded(encoding), first); // 只压缩一次
+    }
+}
+
+TEST(Compression, EncodedBodySkipsUselessCompression) {
+    // 压缩后没有变小的内容只尝试一次，之后一直返回 nullptr
+    EncodedBody body("{}");
+    EXPECT_EQ(body.encoded(ContentEncoding::Gzip), nullptr);
+    EXPECT_EQ(body.encoded(ContentEncoding::Gzip), nullptr);
+}
+
+TEST(Compression, TranscodedBodyHasItsOwnEncodings) {
+    EncodedBody body(repetitiveJson());
+    EXPECT_EQ(body.transcoded(BodyFormat::Json), nullptr);
+    auto msgpack = body.transcoded(BodyFormat::MessagePack);
+    ASSERT_NE(msgpack, nullptr);
+    EXPECT_EQ(body.transcoded(BodyFormat::MessagePack), msgpack);
+    auto gzip = msgpack->encoded(ContentEncoding::Gzip);
+    ASSERT_NE(gzip, nullptr);
+    EXPECT_NE(gzip, body.encoded(ContentEncoding::Gzip));
+
+    EncodedBody invalid("not json");
+    EXPECT_EQ(invalid.transcoded(BodyFormat::Cbor), nullptr);
+    EXPECT_EQ(invalid.transcoded(BodyFormat::Cbor), nullptr);
+}
+
+TEST(Compression, ConcurrentRequestsShareOneResult) {
+    EncodedBody body(repetitiveJson());
+    constexpr int kThreads = 8;
+    std::atomic<int> ready{0};
+    std::vector<std::shared_ptr<const std::string>> gzip(kThreads);
+    std::vector<std::shared_ptr<const std::string>> brotli(kThreads);
+    std::vector<std::shared_ptr<const EncodedBody>> cbor(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&, i] {
+            ready.fetch_add(1);
+            while (ready.load() < kThreads) {
+            }
+            // 不同线程以不同顺序请求不同的槽位
+            if (i % 2) {
+                brotli[i] = body.encoded(ContentEncoding::Brotli);
+                gzip[i] = body.encoded(ContentEncoding::Gzip);
+            } else {
+                gzip[i] = body.encoded(ContentEncoding::Gzip);
+                brotli[i] = body.encoded(ContentEncoding::Brotli);
+            }
+            cbor[i] = body.transcoded(BodyFormat::Cbor);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < kThreads; ++i) {
+        ASSERT_NE(gzip[i], nullptr);
+        EXPECT_EQ(gzip[i], gzip[0]);
+        EXPECT_EQ(brotli[i], brotli[0]);
+        EXPECT_EQ(cbor[i], cbor[0]);
+    }
+}
@@ -0,0 +1,244 @@
+// HttpParser 单元测试：分段到达、流水线请求、各项上限与错误状态码
+
+#include "mod/HttpParser.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+// 把 input 按 chunkSize 分段追加到缓冲区，每段之后调用一次 parse，模拟多次 recv
+HttpParser::Result feed(HttpParser& parser, std::string& buffer, std::string_view input, size_t chunkSize,
+                        HttpRequest& request) {
+    auto result = HttpParser::Result::Incomplete;
+    for (size_t offset = 0; offset < input.size(); offset += chunkSize) {
+        buffer.append(input.substr(offset, chunkSize));
+        result = parser.parse(buffer, request);
+        if (result != HttpParser::Result::Incomplete) {
+            break;
+        }
+    }
+    return result;
+}
+
+struct ErrorCase {
+    const char* name;
+    std::string input;
+    int status;
+};
+
+std::string headersOfCount(size_t count) {
+    std::string request = "GET / HTTP/1.1\r\n";
+    for (size_t i = 0; i < count; ++i) {
+        request += "X-H" + std::to_string(i) + ": v\r\n";
+    }
+    return request + "\r\n";
+}
+
+} // namespace
+
+// ==================== 正常请求 ====================
+
+TEST(HttpParser, ParsesCompleteRequest) {
+    std::string buffer = "GET /api/v1/players?fields=name&token=a%20b HTTP/1.1\r\nHost: x\r\nAccept: */*\r\n\r\n";
+    HttpParser parser;
+    HttpRequest request;
+    ASSERT_EQ(parser.parse(buffer, request), HttpParser::Result::Complete);
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.path, "/api/v1/players");
+    EXPECT_EQ(request.query, "fields=name&token=a%20b");
+    EXPECT_EQ(request.version, "HTTP/1.1");
+    EXPECT_EQ(request.getHeader("host"), "x");
+    EXPECT_EQ(request.getParam("token"), "a b");
+    EXPECT_EQ(parser.consumed(), buffer.size());
+}
+
+TEST(HttpParser, SplitReadsAtEveryChunkSize) {
+    const std::string input = "POST /api/v1/batch HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n\r\nhello world";
+    for (size_t chunk = 1; chunk <= input.size(); ++chunk) {
+        SCOPED_TRACE("chunk size " + std::to_string(chunk));
+        HttpParser parser;
+        HttpRequest request;
+        std::string buffer;
+        ASSERT_EQ(feed(parser, buffer, input, chunk, request), HttpParser::Result::Complete);
+        EXPECT_EQ(request.method, "POST");
+        EXPECT_EQ(request.path, "/api/v1/batch");
+        EXPECT_EQ(request.body, "hello world");
+        EXPECT_EQ(parser.consumed(), input.size());
+    }
+}
+
+TEST(HttpParser, PartialRequestIsIncomplete) {
+    const std::vector<std::string> partials = {
+        "",
+        "GET",
+        "GET / HTTP/1.1",
+        "GET / HTTP/1.1\r\nHost: x\r\n",
+        "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nabc",
+    };
+    for (const auto& input : partials) {
+        SCOPED_TRACE(input);
+        HttpParser parser;
+        HttpRequest request;
+        EXPECT_EQ(parser.parse(input, request), HttpParser::Result::Incomplete);
+    }
+}
+
+TEST(HttpParser, ReportsBodyState) {
+    std::string buffer = "POST / HTTP/1.1\r\nContent-Length: 5\r\n";
+    HttpParser parser;
+    HttpRequest request;
+    ASSERT_EQ(parser.parse(buffer, request), HttpParser::Result::Incomplete);
+    EXPECT_TRUE(parser.hasPartialRequest());
+    EXPECT_FALSE(parser.receivingBody());
+    buffer += "\r\nab";
+    ASSERT_EQ(parser.parse(buffer, request), HttpParser::Result::Incomplete);
+    EXPECT_TRUE(parser.receivingBody());
+}
+
+TEST(HttpParser, PipelinedRequestsInOneBuffer) {
+    std::string buffer = "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+                         "POST /b HTTP/1.1\r\nContent-Length: 3\r\n\r\nxyz"
+                         "GET /c?q=1 HTTP/1.1\r\n\r\n"
+                         "GET /d HTT";
+    const std::vector<std::string> expectedPaths = {"/a", "/b", "/c"};
+    HttpParser parser;
+    for (const auto& path : expectedPaths) {
+        HttpRequest request;
+        ASSERT_EQ(parser.parse(buffer, request), HttpParser::Result::Complete);
+        EXPECT_EQ(request.path, path);
+        if (path == "/b") {
+            EXPECT_EQ(request.body, "xyz");
+        }
+        // 与 HttpServer::drainCompletions 相同：移除已处理的请求后重置
+        buffer.erase(0, parser.consumed());
+        parser.reset();
+    }
+    HttpRequest request;
+    EXPECT_EQ(parser.parse(buffer, request), HttpParser::Result::Incomplete);
+    EXPECT_EQ(buffer, "GET /d HTT");
+}
+
+TEST(HttpParser, ToleratesLeadingEmptyLinesAndBareLf) {
+    std::string buffer = "\r\n\nGET /x HTTP/1.1\nHost: y\n\n";
+    HttpParser parser;
+    HttpRequest request;
+    ASSERT_EQ(parser.parse(buffer, request), HttpParser::Result::Complete);
+    EXPECT_EQ(request.path, "/x");
+    EXPECT_EQ(request.getHeader("Host"), "y");
+}
+
+// ==================== 上限 ====================
+
+TEST(HttpParser, HeaderLimitsAtBoundary) {
+    HttpParser::Limits limits;
+
+    HttpRequest request;
+    HttpParser atLimit;
+    std::string maxHeaders = headersOfCount(limits.maxHeaderCount);
+    EXPECT_EQ(atLimit.parse(maxHeaders, request), HttpParser::Result::Complete);
+
+    HttpParser overLimit;
+    std::string tooManyHeaders = headersOfCount(limits.maxHeaderCount + 1);
+    EXPECT_EQ(overLimit.parse(tooManyHeaders, request), HttpParser::Result::Error);
+    EXPECT_EQ(overLimit.errorStatus(), 431);
+
+    // 请求头总长度在上限以内
+    std::string big = "GET / HTTP/1.1\r\nX-Big: " + std::string(limits.maxHeaderBytes - 64, 'a') + "\r\n\r\n";
+    HttpParser underBytes;
+    EXPECT_EQ(underBytes.parse(big, request), HttpParser::Result::Complete);
+}
+
+TEST(HttpParser, BodyLimitAtBoundary) {
+    HttpParser::Limits limits;
+    HttpRequest request;
+
+    std::string maxBody = "POST / HTTP/1.1\r\nContent-Length: " + std::to_string(limits.maxBodyBytes) + "\r\n\r\n" +
+                          std::string(limits.maxBodyBytes, 'b');
+    HttpParser atLimit;
+    ASSERT_EQ(atLimit.parse(maxBody, request), HttpParser::Result::Complete);
+    EXPECT_EQ(request.body.size(), limits.maxBodyBytes);
+
+    // 超过上限的 Content-Length 在收到请求体之前就被拒绝
+    std::string tooBig = "POST / HTTP/1.1\r\nContent-Length: " + std::to_string(limits.maxBodyBytes + 1) + "\r\n";
+    HttpParser overLimit;
+    EXPECT_EQ(overLimit.parse(tooBig, request), HttpParser::Result::Error);
+    EXPECT_EQ(overLimit.errorStatus(), 413);
+}
+
+TEST(HttpParser, HeaderBytesLimitWithoutNewline) {
+    // 一直不发送换行符的客户端在超过上限后立即被拒绝，而不是无限缓存
+    HttpParser::Limits limits;
+    HttpParser parser;
+    HttpRequest request;
+    std::string buffer;
+    std::string input = "GET /" + std::string(limits.maxHeaderBytes + 16, 'a');
+    EXPECT_EQ(feed(parser, buffer, input, 1024, request), HttpParser::Result::Error);
+    EXPECT_EQ(parser.errorStatus(), 431);
+    EXPECT_LE(buffer.size(), limits.maxHeaderBytes + 1024);
+}
+
+TEST(HttpParser, CustomLimits) {
+    HttpParser::Limits limits;
+    limits.maxHeaderCount = 2;
+    limits.maxBodyBytes = 4;
+    HttpRequest request;
+
+    HttpParser headers(limits);
+    std::string threeHeaders = headersOfCount(3);
+    EXPECT_EQ(headers.parse(threeHeaders, request), HttpParser::Result::Error);
+    EXPECT_EQ(headers.errorStatus(), 431);
+
+    HttpParser body(limits);
+    std::string fiveBytes = "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nabcde";
+    EXPECT_EQ(body.parse(fiveBytes, request), HttpParser::Result::Error);
+    EXPECT_EQ(body.errorStatus(), 413);
+}
+
+// ==================== 错误请求 ====================
+
+TEST(HttpParser, RejectsMalformedRequests) {
+    const std::vector<ErrorCase> cases = {
+        {"missing target", "GET\r\n\r\n", 400},
+        {"empty target", "GET  HTTP/1.1\r\n\r\n", 400},
+        {"missing version", "GET /\r\n\r\n", 400},
+        {"bad version", "GET / FTP/1.0\r\n\r\n", 400},
+        {"leading space", " GET / HTTP/1.1\r\n\r\n", 400},
+        {"header without colon", "GET / HTTP/1.1\r\nHost x\r\n\r\n", 400},
+        {"empty header name", "GET / HTTP/1.1\r\n: x\r\n\r\n", 400},
+        {"transfer-encoding", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 501},
+        {"transfer-encoding any case", "POST / HTTP/1.1\r\ntransfer-encoding: gzip\r\n\r\n", 501},
+        {"content-length not a number", "POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n", 400},
+        {"content-length negative", "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", 400},
+        {"content-length trailing garbage", "POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n", 400},
+        {"content-length empty", "POST / HTTP/1.1\r\nContent-Length: \r\n\r\n", 400},
+        {"content-length overflow", "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n", 400},
+    };
+    for (const auto& testCase : cases) {
+        SCOPED_TRACE(testCase.name);
+        HttpParser parser;
+        HttpRequest request;
+        ASSERT_EQ(parser.parse(testCase.input, request), HttpParser::Result::Error);
+        EXPECT_EQ(parser.errorStatus(), testCase.status);
+        EXPECT_NE(std::string_view(parser.errorText()), "");
+        // 出错后保持失败状态，不会把后续数据当作新请求
+        EXPECT_EQ(parser.parse(testCase.input, request), HttpParser::Result::Error);
+    }
+}
+
+TEST(HttpParser, ErrorsAreFoundOnSplitReads) {
+    const std::string input = "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n";
+    for (size_t chunk = 1; chunk <= input.size(); ++chunk) {
+        SCOPED_TRACE("chunk size " + std::to_string(chunk));
+        HttpParser parser;
+        HttpRequest request;
+        std::string buffer;
+        ASSERT_EQ(feed(parser, buffer, input, chunk, request), HttpParser::Result::Error);
+        EXPECT_EQ(parser.errorStatus(), 400);
+    }
+}
@@ -0,0 +1,84 @@
+// JsonWriter 单元测试：字符串转义、UTF-8 替换与结构生成
+
+#include "mod/JsonWriter.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+std::string escaped(std::string_view value) {
+    std::string out;
+    appendJsonString(out, value);
+    return out;
+}
+
+} // namespace
+
+// ==================== 字符串 ====================
+
+TEST(JsonWriter, EscapesControlCharacters) {
+    EXPECT_EQ(escaped(""), R"("")");
+    EXPECT_EQ(escaped("Steve"), R"("Steve")");
+    EXPECT_EQ(escaped("a\"b\\c"), R"("a\"b\\c")");
+    EXPECT_EQ(escaped("\b\f\n\r\t"), R"("\b\f\n\r\t")");
+    EXPECT_EQ(escaped(std::string("\x01\x1f\0", 3)), R"("\u0001\u001f\u0000")");
+    EXPECT_EQ(escaped("/\x7f"), "\"/\x7f\"");
+}
+
+TEST(JsonWriter, KeepsValidUtf8) {
+    for (const char* text : {"\xE4\xBD\xA0\xE5\xA5\xBD", "caf\xC3\xA9", "\xF0\x9F\x98\x80!", "\xEF\xBF\xBD"}) {
+        SCOPED_TRACE(text);
+        EXPECT_EQ(escaped(text), std::string("\"") + text + "\"");
+    }
+}
+
+TEST(JsonWriter, ReplacesInvalidUtf8) {
+    struct Case {
+        const char* input;
+        const char* expected;
+    };
+    const Case cases[] = {
+        {"\xFF", R"("\ufffd")"},
+        {"a\x80z", R"("a\ufffdz")"},
+        {"\xC0\xAF", R"("\ufffd\ufffd")"},             // 过长编码：两个字节各自替换
+        {"\xED\xA0\x80", R"("\ufffd\ufffd\ufffd")"},  // 代理区
+        {"\xE4\xBD", R"("\ufffd")"},                    // 截断的三字节字符只替换一次
+        {"\xE4\xBDx\"", R"("\ufffdx\"")"},             // 截断后的字符照常处理
+        {"\xF0\x9F\x98", R"("\ufffd")"},
+        {"\xF4\x90\x80\x80", R"("\ufffd\ufffd\ufffd\ufffd")"},
+        {"ok\xC3\xA9\xC3", "\"ok\xC3\xA9\\ufffd\""},
+    };
+    for (const auto& testCase : cases) {
+        SCOPED_TRACE(testCase.expected);
+        EXPECT_EQ(escaped(testCase.input), testCase.expected);
+    }
+}
+
+// ==================== 结构 ====================
+
+TEST(JsonWriter, WritesNestedStructures) {
+    std::string out;
+    JsonWriter json(out);
+    json.beginObject()
+        .field("name", "Steve")
+        .field("count", 3)
+        .field("ratio", 0.5)
+        .field("nan", std::nan(""))
+        .field("op", false)
+        .field("none", nullptr)
+        .field("list", std::vector<int>{1, 2})
+        .key("raw")
+        .rawValue(R"({"a":1})")
+        .key("empty")
+        .beginArray()
+        .endArray()
+        .endObject();
+    EXPECT_EQ(out, R"({"name":"Steve","count":3,"ratio":0.5,"nan":null,"op":false,"none":null,"list":[1,2],)"
+                   R"("raw":{"a":1},"empty":[]})");
+}
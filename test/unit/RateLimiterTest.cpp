@@ -0,0 +1,207 @@
+// RateLimiter 单元测试：令牌补充、突发上限、探测窗口耗尽时放行、闲置回收与复用
+
+#include "mod/RateLimiter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace serverinfo_rest;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct AcquireResult {
+    bool allowed;
+    std::chrono::milliseconds retryAfter;
+};
+
+AcquireResult acquire(RateLimiter& limiter, const std::string& key, const RateLimitRule& rule, Clock::time_point now) {
+    std::chrono::milliseconds retryAfter{-1};
+    bool allowed = limiter.tryAcquire(key, rule, now, retryAfter);
+    return {allowed, retryAfter};
+}
+
+// 在 now 时刻连续扣减，返回成功的次数 (最多 limit 次)
+int drain(RateLimiter& limiter, const std::string& key, const RateLimitRule& rule, Clock::time_point now,
+          int limit = 10000) {
+    int granted = 0;
+    while (granted < limit && acquire(limiter, key, rule, now).allowed) {
+        granted++;
+    }
+    return granted;
+}
+
+} // namespace
+
+// ==================== 令牌桶计算 ====================
+
+TEST(RateLimiter, BurstIsGrantedThenRejected) {
+    RateLimiter limiter(64, 60s);
+    auto t0 = Clock::now();
+    RateLimitRule rule{10, 5};
+    EXPECT_EQ(drain(limiter, "ip:a", rule, t0), 5);
+
+    auto rejected = acquire(limiter, "ip:a", rule, t0);
+    EXPECT_FALSE(rejected.allowed);
+    EXPECT_EQ(rejected.retryAfter, 100ms); // 每秒 10 个，下一个令牌 100ms 后补充
+    EXPECT_EQ(limiter.rejectedCount(), 2u);
+}
+
+TEST(RateLimiter, RefillFollowsElapsedTime) {
+    struct Case {
+        uint32_t rate;
+        uint32_t burst;
+        std::chrono::milliseconds elapsed;
+        int expected; // 清空后经过 elapsed 可以再扣减的次数
+    };
+    const Case cases[] = {
+        {10, 5, 99ms, 0},   {10, 5, 100ms, 1},  {10, 5, 250ms, 2},  {10, 5, 500ms, 5},
+        {1, 3, 999ms, 0},   {1, 3, 1000ms, 1},  {1000, 10, 1ms, 1}, {1000, 10, 5ms, 5},
+        {3, 2, 333ms, 0},   {3, 2, 334ms, 1},
+    };
+    for (const auto& c : cases) {
+        SCOPED_TRACE("rate " + std::to_string(c.rate) + " burst " + std::to_string(c.burst) + " after " +
+                     std::to_string(c.elapsed.count()) + "ms");
+        RateLimiter limiter(64, 60s);
+        auto t0 = Clock::now();
+        RateLimitRule rule{c.rate, c.burst};
+        ASSERT_EQ(drain(limiter, "k", rule, t0), static_cast<int>(c.burst));
+        EXPECT_EQ(drain(limiter, "k", rule, t0 + c.elapsed), c.expected);
+    }
+}
+
+TEST(RateLimiter, RetryAfterMatchesRefill) {
+    RateLimiter limiter(64, 60s);
+    auto t0 = Clock::now();
+    RateLimitRule rule{3, 1};
+    ASSERT_TRUE(acquire(limiter, "k", rule, t0).allowed);
+    auto rejected = acquire(limiter, "k", rule, t0 + 100ms);
+    ASSERT_FALSE(rejected.allowed);
+    // 1000 个千分之一令牌每毫秒补充 3 个：已补充 300，还差 700 -> 234ms
+    EXPECT_EQ(rejected.retryAfter, 234ms);
+    EXPECT_FALSE(acquire(limiter, "k", rule, t0 + 100ms + rejected.retryAfter - 1ms).allowed);
+    EXPECT_TRUE(acquire(limiter, "k", rule, t0 + 100ms + rejected.retryAfter).allowed);
+}
+
+TEST(RateLimiter, BurstCapsAccumulatedTokens) {
+    RateLimiter limiter(64, 600s);
+    auto t0 = Clock::now();
+    RateLimitRule rule{100, 7};
+    ASSERT_EQ(drain(limiter, "k", rule, t0), 7);
+    // 闲置很久也只能攒到 burst 个
+    EXPECT_EQ(drain(limiter, "k", rule, t0 + 60s), 7);
+}
+
+TEST(RateLimiter, KeysAndRulesAreIndependent) {
+    RateLimiter limiter(64, 60s);
+    auto t0 = Clock::now();
+    EXPECT_EQ(drain(limiter, "ip:a", {1, 2}, t0), 2);
+    EXPECT_EQ(drain(limiter, "ip:b", {1, 3}, t0), 3);
+    EXPECT_EQ(drain(limiter, "token:a", {1, 4}, t0), 4);
+    EXPECT_EQ(limiter.trackedCount(), 3u);
+}
+
+TEST(RateLimiter, ZeroRateMeansUnlimited) {
+    RateLimiter limiter(64, 60s);
+    auto t0 = Clock::now();
+    EXPECT_EQ(drain(limiter, "k", {0, 1}, t0, 500), 500);
+    EXPECT_EQ(limiter.trackedCount(), 0u);
+}
+
+// ==================== 容量耗尽 ====================
+
+TEST(RateLimiter, FailsOpenWhenProbeWindowIsFull) {
+    // 最小容量：每个分片 16 个桶，探测窗口同样是 16，所以最多跟踪 16 * 16 个客户端
+    RateLimiter limiter(1, 60s);
+    auto t0 = Clock::now();
+    RateLimitRule rule{1, 1};
+    constexpr int kKeys = 2000;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(acquire(limiter, "ip:" + std::to_string(i), rule, t0).allowed);
+    }
+    EXPECT_LE(limiter.trackedCount(), 256u);
+    EXPECT_GT(limiter.trackedCount(), 0u);
+
+    // 被跟踪的客户端第二次请求被拒绝，没有位置的客户端不受限 (宁可放行也不误伤)
+    int limited = 0;
+    int unlimited = 0;
+    for (int i = 0; i < kKeys; ++i) {
+        if (acquire(limiter, "ip:" + std::to_string(i), rule, t0).allowed) {
+            unlimited++;
+        } else {
+            limited++;
+        }
+    }
+    EXPECT_EQ(static_cast<size_t>(limited), limiter.trackedCount());
+    EXPECT_EQ(limited + unlimited, kKeys);
+    EXPECT_GT(unlimited, 0);
+}
+
+// ==================== 闲置回收 ====================
+
+TEST(RateLimiter, EvictIdleLeavesActiveBuckets) {
+    RateLimiter limiter(64, 1000ms);
+    auto t0 = Clock::now();
+    RateLimitRule rule{1, 1};
+    ASSERT_TRUE(acquire(limiter, "a", rule, t0).allowed);
+    ASSERT_TRUE(acquire(limiter, "b", rule, t0 + 600ms).allowed);
+    EXPECT_EQ(limiter.evictIdle(t0 + 999ms), 0u);
+    EXPECT_EQ(limiter.evictIdle(t0 + 1000ms), 1u);
+    EXPECT_EQ(limiter.trackedCount(), 1u);
+    EXPECT_EQ(limiter.evictIdle(t0 + 1600ms), 1u);
+    EXPECT_EQ(limiter.trackedCount(), 0u);
+}
+
+TEST(RateLimiter, EvictedKeyStartsWithFullBucket) {
+    RateLimiter limiter(64, 1000ms);
+    auto t0 = Clock::now();
+    RateLimitRule rule{1, 3};
+    ASSERT_EQ(drain(limiter, "a", rule, t0), 3);
+    ASSERT_EQ(limiter.evictIdle(t0 + 1000ms), 1u);
+    // 标记为已删除的位置被重新使用
+    EXPECT_EQ(drain(limiter, "a", rule, t0 + 1000ms), 3);
+    EXPECT_EQ(limiter.trackedCount(), 1u);
+}
+
+TEST(RateLimiter, TombstonesKeepProbeChainsIntact) {
+    RateLimiter limiter(1, 1000ms);
+    auto t0 = Clock::now();
+    RateLimitRule rule{1, 1};
+    constexpr int kKeys = 64;
+    for (int i = 0; i < kKeys; ++i) {
+        ASSERT_TRUE(acquire(limiter, std::to_string(i), rule, t0 + std::chrono::milliseconds(i % 2 ? 500 : 0)).allowed);
+    }
+    ASSERT_EQ(limiter.trackedCount(), static_cast<size_t>(kKeys));
+    // 回收偶数 key 后，奇数 key 仍然能被找到 (依然处于限流状态)
+    EXPECT_EQ(limiter.evictIdle(t0 + 1000ms), static_cast<size_t>(kKeys / 2));
+    for (int i = 1; i < kKeys; i += 2) {
+        EXPECT_FALSE(acquire(limiter, std::to_string(i), rule, t0 + 1000ms).allowed) << "key " << i;
+    }
+}
+
+TEST(RateLimiter, IdleBucketIsTakenOverWhenWindowIsFull) {
+    RateLimiter limiter(1, 1000ms);
+    auto t0 = Clock::now();
+    RateLimitRule rule{1, 1};
+    constexpr int kKeys = 2000;
+    for (int i = 0; i < kKeys; ++i) {
+        acquire(limiter, "old:" + std::to_string(i), rule, t0);
+    }
+    size_t tracked = limiter.trackedCount();
+
+    // 窗口已满，但旧客户端都已闲置：新客户端不等回收直接接管，并且受到限流
+    auto later = t0 + 1000ms;
+    int limited = 0;
+    for (int i = 0; i < 100; ++i) {
+        std::string key = "new:" + std::to_string(i);
+        ASSERT_TRUE(acquire(limiter, key, rule, later).allowed);
+        if (!acquire(limiter, key, rule, later).allowed) {
+            limited++;
+        }
+    }
+    EXPECT_EQ(limited, 100);
+    EXPECT_EQ(limiter.trackedCount(), tracked); // 接管不改变跟踪数量
+}
@@ -0,0 +1,126 @@
+// TimeSeries 单元测试：分辨率选择、聚合、步长取整，以及极端参数不会溢出或长时间遍历
+
+#include "mod/TimeSeries.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+constexpr int64_t kNow = 1700000000;
+constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+
+// 最近 seconds 秒每秒一个样本，值为 1
+void recordRecent(TimeSeries& series, int64_t seconds) {
+    for (int64_t t = kNow - seconds + 1; t <= kNow; ++t) {
+        series.record(t, 1);
+    }
+}
+
+uint64_t totalCount(const std::vector<TimeSeriesPoint>& points) {
+    uint64_t count = 0;
+    for (const auto& point : points) count += point.count;
+    return count;
+}
+
+} // namespace
+
+// ==================== 查询 ====================
+
+TEST(TimeSeries, AggregatesGaugeByStep) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    for (int64_t t = kNow - 59; t <= kNow; ++t) {
+        series.record(t, static_cast<double>(t % 10));
+    }
+    std::vector<TimeSeriesPoint> points;
+    int64_t step = series.query(kNow - 59, kNow, 10, points);
+    EXPECT_EQ(step, 10);
+    ASSERT_FALSE(points.empty());
+    EXPECT_EQ(totalCount(points), 60u);
+    for (const auto& point : points) {
+        EXPECT_EQ(point.time % 10, 0);
+        EXPECT_LE(point.min, point.max);
+    }
+}
+
+TEST(TimeSeries, PicksResolutionThatCoversFrom) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    recordRecent(series, 3 * 3600);
+    std::vector<TimeSeriesPoint> points;
+    // 1 秒分辨率只保留 1 小时，3 小时前的数据来自 1 分钟分辨率，步长向上取整到 60 的倍数
+    int64_t step = series.query(kNow - 3 * 3600 + 1, kNow, 30, points);
+    EXPECT_EQ(step, 60);
+    EXPECT_EQ(totalCount(points), 3u * 3600);
+}
+
+TEST(TimeSeries, LimitsPointCount) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    recordRecent(series, 3600);
+    std::vector<TimeSeriesPoint> points;
+    int64_t step = series.query(kNow - 3599, kNow, 1, points);
+    EXPECT_GE(step, 4);
+    EXPECT_LE(points.size(), TimeSeries::kMaxPoints + 1);
+    EXPECT_EQ(totalCount(points), 3600u);
+}
+
+TEST(TimeSeries, EmptyRanges) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    recordRecent(series, 60);
+    std::vector<TimeSeriesPoint> points;
+    series.query(kNow, kNow - 1, 1, points);
+    series.query(kNow + 1, kNow + 100, 1, points);
+    series.query(kNow - 10 * TimeSeries::kMaxRetention, kNow - 2 * TimeSeries::kMaxRetention, 1, points);
+    EXPECT_TRUE(points.empty());
+}
+
+// ==================== 极端参数 ====================
+
+TEST(TimeSeries, HugeStepIsClampedToRetention) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    recordRecent(series, 600);
+    for (int64_t step : {kMax, kMax - 1, int64_t{1} << 62, TimeSeries::kMaxRetention * 2}) {
+        SCOPED_TRACE(step);
+        std::vector<TimeSeriesPoint> points;
+        int64_t used = series.query(kNow - 599, kNow, step, points);
+        EXPECT_GT(used, 0);
+        EXPECT_LE(used, TimeSeries::kMaxRetention);
+        EXPECT_LE(points.size(), 2u);
+        EXPECT_EQ(totalCount(points), 600u);
+    }
+}
+
+TEST(TimeSeries, ExtremeRangesDoNotOverflow) {
+    TimeSeries series(TimeSeries::Kind::Gauge);
+    recordRecent(series, 600);
+    const int64_t bounds[][2] = {
+        {kMin, kMax}, {kMin, kNow}, {kNow - 599, kMax}, {kMin, kMin}, {kMax, kMax}, {kMax, kMin},
+    };
+    for (const auto& bound : bounds) {
+        for (int64_t step : {kMin, int64_t{-1}, int64_t{0}, int64_t{1}, kMax}) {
+            SCOPED_TRACE(testing::Message() << bound[0] << ".." << bound[1] << " step " << step);
+            std::vector<TimeSeriesPoint> points;
+            series.query(bound[0], bound[1], step, points);
+            EXPECT_LE(points.size(), TimeSeries::kMaxPoints + 1);
+            if (bound[0] <= kNow - 599 && bound[1] >= kNow) {
+                EXPECT_EQ(totalCount(points), 600u);
+            }
+        }
+    }
+}
+
+TEST(TimeSeries, NegativeTimesAlignDown) {
+    TimeSeries series(TimeSeries::Kind::Counter);
+    series.record(-5, 1);
+    series.record(-1, 1);
+    std::vector<TimeSeriesPoint> points;
+    int64_t step = series.query(-10, 0, 10, points);
+    EXPECT_EQ(step, 10);
+    ASSERT_EQ(points.size(), 1u);
+    EXPECT_EQ(points[0].time, -10);
+    EXPECT_EQ(points[0].sum, 2);
+}
@@ -0,0 +1,236 @@
+// TimerWheel 单元测试：跨层级联、析构时取消、到期处理中重新调度、最多推迟一个 tick
+
+#include "mod/TimerWheel.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace serverinfo_rest;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 逐 tick 推进，返回 tag 第一次到期时的时间 (毫秒)，到 limit 仍未到期时返回 -1
+int64_t firstExpiry(TimerWheel& wheel, Clock::time_point start, uint64_t tag, int64_t from, int64_t limit,
+                    int64_t step) {
+    std::vector<uint64_t> expired;
+    for (int64_t now = from; now <= limit; now += step) {
+        expired.clear();
+        wheel.advance(start + std::chrono::milliseconds(now), expired);
+        if (std::find(expired.begin(), expired.end(), tag) != expired.end()) {
+            return now;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+// ==================== 各层级 ====================
+
+TEST(TimerWheel, FiresOnTimeAtEveryLevel) {
+    // 每层 64 个槽位：分别落在第 0 ~ 3 层以及超出最高层范围的位置
+    const int64_t deadlines[] = {1,    63,     64,     65,       4095,     4096,     4097,
+                                 262143, 262144, 262145, 16777215, 16777216, 20000000};
+    for (int64_t deadline : deadlines) {
+        SCOPED_TRACE("deadline " + std::to_string(deadline) + " ticks");
+        auto start = Clock::now();
+        TimerWheel wheel(1ms, start);
+        TimerNode node;
+        node.tag = 7;
+        wheel.schedule(node, start + std::chrono::milliseconds(deadline));
+        ASSERT_TRUE(node.scheduled());
+
+        // 先大步跳到到期前一刻 (经过所有需要的级联)，然后逐 tick 检查
+        std::vector<uint64_t> expired;
+        wheel.advance(start + std::chrono::milliseconds(deadline - 1), expired);
+        EXPECT_TRUE(expired.empty());
+        EXPECT_EQ(firstExpiry(wheel, start, 7, deadline, deadline + 1, 1), deadline);
+        EXPECT_FALSE(node.scheduled());
+        EXPECT_EQ(wheel.size(), 0u);
+    }
+}
+
+TEST(TimerWheel, CascadesManyTimersAcrossLevelsInOrder) {
+    auto start = Clock::now();
+    TimerWheel wheel(1ms, start);
+    std::vector<std::unique_ptr<TimerNode>> nodes;
+    std::map<uint64_t, int64_t> deadlines;
+    std::mt19937_64 rng(1);
+    for (uint64_t tag = 0; tag < 2000; ++tag) {
+        int64_t deadline = 1 + static_cast<int64_t>(rng() % 300000);
+        auto node = std::make_unique<TimerNode>();
+        node->tag = tag;
+        wheel.schedule(*node, start + std::chrono::milliseconds(deadline));
+        nodes.push_back(std::move(node));
+        deadlines[tag] = deadline;
+    }
+
+    std::vector<uint64_t> expired;
+    int64_t previous = 0;
+    for (int64_t now = 37; previous < 300000; now += 37) {
+        expired.clear();
+        wheel.advance(start + std::chrono::milliseconds(now), expired);
+        for (uint64_t tag : expired) {
+            // 不会提前，也不会晚于本次推进的区间
+            EXPECT_LE(deadlines[tag], now) << "tag " << tag;
+            EXPECT_GT(deadlines[tag], previous) << "tag " << tag;
+            deadlines.erase(tag);
+        }
+        previous = now;
+    }
+    EXPECT_TRUE(deadlines.empty());
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+// ==================== 取消 ====================
+
+TEST(TimerWheel, CancelAndDestructorUnlink) {
+    auto start = Clock::now();
+    TimerWheel wheel(10ms, start);
+    TimerNode kept;
+    kept.tag = 1;
+    TimerNode cancelled;
+    cancelled.tag = 2;
+    wheel.schedule(kept, start + 100ms);
+    wheel.schedule(cancelled, start + 100ms);
+    {
+        // 同一个槽位中的节点在析构时自行移除，不影响链表中的其他节点
+        TimerNode destroyed;
+        destroyed.tag = 3;
+        wheel.schedule(destroyed, start + 100ms);
+        EXPECT_EQ(wheel.size(), 3u);
+    }
+    EXPECT_EQ(wheel.size(), 2u);
+    cancelled.cancel();
+    cancelled.cancel(); // 重复取消没有影响
+    EXPECT_FALSE(cancelled.scheduled());
+    EXPECT_EQ(wheel.size(), 1u);
+
+    std::vector<uint64_t> expired;
+    wheel.advance(start + 1s, expired);
+    EXPECT_EQ(expired, std::vector<uint64_t>{1});
+}
+
+TEST(TimerWheel, NodesOutliveWheel) {
+    auto start = Clock::now();
+    auto node = std::make_unique<TimerNode>();
+    {
+        TimerWheel wheel(10ms, start);
+        wheel.schedule(*node, start + 1s);
+        EXPECT_TRUE(node->scheduled());
+    }
+    // 时间轮先销毁时节点被标记为未调度，析构不会访问已释放的槽位
+    EXPECT_FALSE(node->scheduled());
+    node.reset();
+}
+
+TEST(TimerWheel, RescheduleMovesNode) {
+    auto start = Clock::now();
+    TimerWheel wheel(10ms, start);
+    TimerNode node;
+    node.tag = 5;
+    wheel.schedule(node, start + 5s);
+    wheel.schedule(node, start + 50ms);
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(firstExpiry(wheel, start, 5, 0, 6000, 10), 50);
+}
+
+// ==================== 到期处理中重新调度 ====================
+
+TEST(TimerWheel, RearmWhileHandlingExpiry) {
+    auto start = Clock::now();
+    TimerWheel wheel(10ms, start);
+    std::vector<std::unique_ptr<TimerNode>> nodes;
+    for (uint64_t tag = 0; tag < 8; ++tag) {
+        nodes.push_back(std::make_unique<TimerNode>());
+        nodes.back()->tag = tag;
+        wheel.schedule(*nodes.back(), start + 100ms);
+    }
+
+    // 与 HttpServer::expireDeadlines 相同：遍历到期列表时为部分节点重新调度，并销毁另一部分
+    std::vector<uint64_t> expired;
+    wheel.advance(start + 100ms, expired);
+    ASSERT_EQ(expired.size(), 8u);
+    for (uint64_t tag : expired) {
+        if (tag % 2 == 0) {
+            wheel.schedule(*nodes[tag], start + 300ms);
+        } else if (tag == 1) {
+            // 已经过期的时间放到下一个 tick
+            wheel.schedule(*nodes[tag], start + 50ms);
+        } else {
+            nodes[tag].reset();
+        }
+    }
+    EXPECT_EQ(wheel.size(), 5u);
+
+    expired.clear();
+    wheel.advance(start + 110ms, expired);
+    EXPECT_EQ(expired, std::vector<uint64_t>{1});
+
+    expired.clear();
+    wheel.advance(start + 299ms, expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.advance(start + 300ms, expired);
+    std::sort(expired.begin(), expired.end());
+    EXPECT_EQ(expired, (std::vector<uint64_t>{0, 2, 4, 6}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+// ==================== 精度 ====================
+
+TEST(TimerWheel, NeverEarlyAndAtMostOneTickLate) {
+    constexpr int64_t kTick = 10;
+    auto start = Clock::now();
+    TimerWheel wheel(std::chrono::milliseconds(kTick), start);
+    std::mt19937_64 rng(42);
+    std::vector<std::unique_ptr<TimerNode>> nodes(500);
+    std::map<uint64_t, int64_t> deadlines;
+    for (uint64_t tag = 0; tag < nodes.size(); ++tag) {
+        nodes[tag] = std::make_unique<TimerNode>();
+        nodes[tag]->tag = tag;
+    }
+
+    std::vector<uint64_t> expired;
+    int64_t now = 0;
+    for (int step = 0; step < 50000; ++step) {
+        uint64_t tag = rng() % nodes.size();
+        switch (rng() % 4) {
+        case 0: {
+            // 截止时间不在 tick 边界上，检查向上取整
+            int64_t deadline = now + static_cast<int64_t>(rng() % 20000);
+            wheel.schedule(*nodes[tag], start + std::chrono::milliseconds(deadline));
+            deadlines[tag] = deadline;
+            break;
+        }
+        case 1:
+            nodes[tag]->cancel();
+            deadlines.erase(tag);
+            break;
+        default:
+            // 事件循环每 tick 醒来一次，偶尔会有抖动
+            now += kTick + static_cast<int64_t>(rng() % 3);
+            expired.clear();
+            wheel.advance(start + std::chrono::milliseconds(now), expired);
+            for (uint64_t expiredTag : expired) {
+                auto it = deadlines.find(expiredTag);
+                ASSERT_NE(it, deadlines.end());
+                EXPECT_LE(it->second, now);
+                deadlines.erase(it);
+            }
+            // 所有截止时间早于当前时间一个 tick 以上的定时器都已触发
+            for (const auto& [pending, deadline] : deadlines) {
+                ASSERT_GT(deadline + kTick, now) << "tag " << pending << " is late";
+            }
+            break;
+        }
+        ASSERT_EQ(wheel.size(), deadlines.size());
+    }
+}
@@ -0,0 +1,159 @@
+// WebSocket 单元测试：握手计算、帧解码、UTF-8 校验与关闭帧状态码
+
+#include "mod/Utf8.h"
+#include "mod/WebSocket.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+using namespace serverinfo_rest;
+
+namespace {
+
+// 按客户端的格式编码一帧 (带掩码)
+std::string clientFrame(WebSocketOpcode opcode, std::string_view payload, bool fin = true) {
+    std::string frame = encodeWebSocketFrame(opcode, payload);
+    size_t headerSize = payload.size() < 126 ? 2 : payload.size() <= 0xFFFF ? 4 : 10;
+    if (!fin) frame[0] = static_cast<char>(frame[0] & 0x7F);
+    frame[1] = static_cast<char>(frame[1] | 0x80);
+    const char mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::string masked = frame.substr(0, headerSize) + std::string(mask, 4);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        masked += static_cast<char>(payload[i] ^ mask[i % 4]);
+    }
+    return masked;
+}
+
+std::string closePayload(uint16_t code, std::string_view reason = {}) {
+    std::string payload = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+    return payload + std::string(reason);
+}
+
+WebSocketReader::Result readAll(WebSocketReader& reader, std::string& buffer, WebSocketFrame& frame) {
+    auto result = reader.read(buffer, frame);
+    buffer.erase(0, reader.consumed());
+    return result;
+}
+
+} // namespace
+
+// ==================== 握手与帧 ====================
+
+TEST(WebSocket, ComputesAcceptKey) {
+    // RFC 6455 1.3 中的示例
+    EXPECT_EQ(computeWebSocketAccept("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST(WebSocket, ReadsTextAndFragments) {
+    WebSocketReader reader;
+    WebSocketFrame frame;
+    std::string buffer = clientFrame(WebSocketOpcode::Text, "hello");
+    ASSERT_EQ(readAll(reader, buffer, frame), WebSocketReader::Result::Frame);
+    EXPECT_EQ(frame.opcode, WebSocketOpcode::Text);
+    EXPECT_EQ(frame.payload, "hello");
+    EXPECT_TRUE(buffer.empty());
+
+    // 多字节字符跨越分片边界，中间插入一个 ping
+    std::string text = "h\xC3\xA9llo";
+    buffer = clientFrame(WebSocketOpcode::Text, text.substr(0, 2), false) + clientFrame(WebSocketOpcode::Ping, "p") +
+             clientFrame(WebSocketOpcode::Continuation, text.substr(2));
+    ASSERT_EQ(readAll(reader, buffer, frame), WebSocketReader::Result::Frame);
+    EXPECT_EQ(frame.opcode, WebSocketOpcode::Ping);
+    ASSERT_EQ(readAll(reader, buffer, frame), WebSocketReader::Result::Frame);
+    EXPECT_EQ(frame.opcode, WebSocketOpcode::Text);
+    EXPECT_EQ(frame.payload, text);
+}
+
+TEST(WebSocket, RejectsUnmaskedAndOversizedFrames) {
+    WebSocketFrame frame;
+    WebSocketReader unmasked;
+    std::string buffer = encodeWebSocketFrame(WebSocketOpcode::Text, "x");
+    EXPECT_EQ(readAll(unmasked, buffer, frame), WebSocketReader::Result::Error);
+    EXPECT_EQ(unmasked.errorCode(), ws_close::ProtocolError);
+
+    WebSocketReader small(4);
+    buffer = clientFrame(WebSocketOpcode::Text, "hello");
+    EXPECT_EQ(readAll(small, buffer, frame), WebSocketReader::Result::Error);
+    EXPECT_EQ(small.errorCode(), ws_close::MessageTooBig);
+}
+
+// ==================== UTF-8 ====================
+
+TEST(WebSocket, ValidatesUtf8) {
+    EXPECT_TRUE(isValidUtf8(""));
+    EXPECT_TRUE(isValidUtf8("plain ascii"));
+    EXPECT_TRUE(isValidUtf8("\xE4\xBD\xA0\xE5\xA5\xBD"));  // 你好
+    EXPECT_TRUE(isValidUtf8("\xF0\x9F\x98\x80"));          // U+1F600
+    EXPECT_TRUE(isValidUtf8("\xF4\x8F\xBF\xBF"));          // U+10FFFF
+    EXPECT_TRUE(isValidUtf8("\xED\x9F\xBF"));              // U+D7FF
+
+    EXPECT_FALSE(isValidUtf8("\x80"));                     // 孤立的后续字节
+    EXPECT_FALSE(isValidUtf8("\xC0\xAF"));                 // 过长编码
+    EXPECT_FALSE(isValidUtf8("\xE0\x80\xAF"));             // 过长编码
+    EXPECT_FALSE(isValidUtf8("\xED\xA0\x80"));             // 代理区 U+D800
+    EXPECT_FALSE(isValidUtf8("\xF4\x90\x80\x80"));         // 超出 U+10FFFF
+    EXPECT_FALSE(isValidUtf8("\xF5\x80\x80\x80"));
+    EXPECT_FALSE(isValidUtf8("\xE4\xBD"));                 // 截断
+    EXPECT_FALSE(isValidUtf8("ok\xE4\xBDx"));
+    EXPECT_FALSE(isValidUtf8("\xFF"));
+}
+
+TEST(WebSocket, InvalidTextClosesWith1007) {
+    WebSocketFrame frame;
+    WebSocketReader single;
+    std::string buffer = clientFrame(WebSocketOpcode::Text, "bad \xC3(");
+    EXPECT_EQ(readAll(single, buffer, frame), WebSocketReader::Result::Error);
+    EXPECT_EQ(single.errorCode(), ws_close::InvalidPayload);
+
+    WebSocketReader fragmented;
+    buffer = clientFrame(WebSocketOpcode::Text, "ok", false) + clientFrame(WebSocketOpcode::Continuation, "\xED\xA0\x80");
+    EXPECT_EQ(readAll(fragmented, buffer, frame), WebSocketReader::Result::Error);
+    EXPECT_EQ(fragmented.errorCode(), ws_close::InvalidPayload);
+
+    // 二进制消息不校验
+    WebSocketReader binary;
+    buffer = clientFrame(WebSocketOpcode::Binary, "\xFF\xFE");
+    EXPECT_EQ(readAll(binary, buffer, frame), WebSocketReader::Result::Frame);
+}
+
+// ==================== 关闭帧 ====================
+
+TEST(WebSocket, ValidatesCloseFrames) {
+    struct Case {
+        const char* name;
+        std::string payload;
+        WebSocketReader::Result result;
+        uint16_t errorCode;
+    };
+    const Case cases[] = {
+        {"empty", "", WebSocketReader::Result::Frame, 0},
+        {"normal", closePayload(1000), WebSocketReader::Result::Frame, 0},
+        {"with reason", closePayload(1001, "bye \xE2\x9C\x93"), WebSocketReader::Result::Frame, 0},
+        {"1011", closePayload(1011), WebSocketReader::Result::Frame, 0},
+        {"application code", closePayload(4000), WebSocketReader::Result::Frame, 0},
+        {"one byte", std::string(1, '\x03'), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"below range", closePayload(999), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"reserved 1004", closePayload(1004), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"no status 1005", closePayload(1005), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"abnormal 1006", closePayload(1006), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"tls 1015", closePayload(1015), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"unassigned 2000", closePayload(2000), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"above range", closePayload(5000), WebSocketReader::Result::Error, ws_close::ProtocolError},
+        {"invalid reason", closePayload(1000, "\xC0\xAF"), WebSocketReader::Result::Error, ws_close::InvalidPayload},
+    };
+    for (const auto& testCase : cases) {
+        SCOPED_TRACE(testCase.name);
+        WebSocketReader reader;
+        WebSocketFrame frame;
+        std::string buffer = clientFrame(WebSocketOpcode::Close, testCase.payload);
+        ASSERT_EQ(readAll(reader, buffer, frame), testCase.result);
+        if (testCase.result == WebSocketReader::Result::Frame) {
+            EXPECT_EQ(frame.opcode, WebSocketOpcode::Close);
+            EXPECT_EQ(frame.payload, testCase.payload);
+        } else {
+            EXPECT_EQ(reader.errorCode(), testCase.errorCode);
+        }
+    }
+}
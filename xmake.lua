@@ -12,6 +12,7 @@ else
 end
 
 add_requires("levibuildscript")
+add_requires("zlib", "brotli")
 
 if not has_config("vs_runtime") then
     set_runtimes("MD")
@@ -23,12 +24,20 @@ option("target_type")
     set_values("server", "client")
 option_end()
 
+option("log_level") -- 编译进插件的最低日志级别，更详细的日志调用连同参数一起被去掉
+    set_default("trace")
+    set_showmenu(true)
+    set_values("fatal", "error", "warn", "info", "debug", "trace")
+option_end()
+
 target("serverinfo-rest") -- 插件名称
     add_rules("@levibuildscript/linkrule")
     add_rules("@levibuildscript/modpacker")
     add_cxflags( "/EHa", "/utf-8", "/W4", "/w44265", "/w44289", "/w44296", "/w45263", "/w44738", "/w45204")
     add_defines("NOMINMAX", "UNICODE")
-    add_packages("levilamina")
+    local logLevels = {fatal = 0, error = 1, warn = 2, info = 3, debug = 4, trace = 5}
+    add_defines("SERVERINFO_LOG_LEVEL=" .. logLevels[get_config("log_level") or "trace"])
+    add_packages("levilamina", "zlib", "brotli")
     set_exceptions("none") -- To avoid conflicts with /EHa.
     set_kind("shared")
     set_languages("c++20")
@@ -41,3 +50,49 @@ target("serverinfo-rest") -- 插件名称
     else
         add_defines("LL_PLAT_C")
     end
+
+option("bench") -- 构建 JSON 序列化基准测试 (不影响插件本身)
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
+if has_config("bench") then
+    add_requires("nlohmann_json")
+
+    target("serverinfo-rest-bench")
+        set_kind("binary")
+        set_default(false)
+        set_languages("c++20")
+        set_optimize("fastest")
+        add_files("bench/json_bench.cpp", "src/mod/JsonWriter.cpp", "src/mod/PlayerCache.cpp")
+        add_includedirs("src")
+        add_packages("nlohmann_json")
+end
+
+option("tests") -- 构建单元测试 (不影响插件本身)
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
+if has_config("tests") then
+    add_requires("gtest", {configs = {main = true}})
+
+    target("serverinfo-rest-tests")
+        set_kind("binary")
+        set_default(false)
+        set_languages("c++20")
+        add_files(
+            "test/unit/*.cpp",
+            "src/mod/BinaryFormat.cpp",
+            "src/mod/Compression.cpp",
+            "src/mod/HttpParser.cpp",
+            "src/mod/JsonWriter.cpp",
+            "src/mod/RateLimiter.cpp",
+            "src/mod/TimeSeries.cpp",
+            "src/mod/TimerWheel.cpp",
+            "src/mod/WebSocket.cpp"
+        )
+        add_includedirs("src")
+        add_packages("gtest", "zlib", "brotli")
+        add_tests("default")
+end